@@ -7,7 +7,7 @@
 
 using namespace lexus2k::pipeline;
 
-class DataPacket: public IPacket {
+class DataPacket: public Packet<DataPacket> {
 public:
     explicit DataPacket(const std::string& data) : m_data(data) {}
     const std::string& getData() const { return m_data; }
@@ -40,8 +40,8 @@ public:
     void produce() {
         std::string line;
         while (std::getline(m_file, line)) {
-            auto packet = std::make_shared<DataPacket>(line);
-            (*this)[m_outputPadIndex].pushPacket(packet, 100);
+            auto packet = PacketPool<DataPacket>::make(line);
+            (*this)[m_outputPadIndex].pushPacket(std::move(packet), 100);
         }
     }
 
@@ -62,8 +62,8 @@ protected:
     bool processPacket(std::shared_ptr<DataPacket> packet, IPad& inputPad, uint32_t timeoutMs) noexcept override {
         auto data = packet->getData();
         std::reverse(data.begin(), data.end());
-        auto new_packet = std::make_shared<DataPacket>(data);
-        (*this)[m_outputIndex].pushPacket(new_packet, 100);
+        auto new_packet = PacketPool<DataPacket>::make(data);
+        (*this)[m_outputIndex].pushPacket(std::move(new_packet), 100);
         return true;
     }
 
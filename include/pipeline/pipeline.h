@@ -1,6 +1,7 @@
 #ifndef PIPELINE_H
 #define PIPELINE_H
 
+#include <atomic>
 #include <memory>
 #include <vector>
 #include <cstdint>
@@ -8,28 +9,58 @@
 #include <map>
 #include <mutex>
 #include <thread>
+#include <string>
 #include <string_view>
 
 #include "pipeline_packet.h"
+#include "pipeline_packet_pool.h"
+#include "pipeline_executor.h"
 #include "pipeline_pad.h"
 #include "pipeline_pads.h"
 #include "pipeline_node.h"
 #include "pipeline_nodes.h"
 #include "pipeline_sharedmem_node.h"
+#include "pipeline_trace.h"
 
 namespace lexus2k::pipeline
 {
+    /**
+     * @struct ReplicaGroup
+     * @brief The nodes created by `Pipeline::addReplicated()`.
+     * @tparam T The type of the replicated node.
+     */
+    template <typename T>
+    struct ReplicaGroup
+    {
+        Dispatcher* dispatcher; ///< Spreads packets across the replicas. Feed its `"input"` pad.
+        std::vector<T*> replicas; ///< The replicas, in the order of the dispatcher outputs.
+    };
+
     /**
      * @class Pipeline
      * @brief Manages a collection of nodes and their connections.
+     *
+     * The pipeline owns an executor. Queued pads of its nodes run as tasks
+     * on the executor's thread pool instead of starting a thread each. The
+     * scheduler is selected at construction.
      */
     class Pipeline
     {
     public:
         /**
-         * @brief Default constructor.
+         * @brief Constructor.
+         * @param threadCount The number of executor threads. `0` selects the
+         *        number of hardware threads.
          */
-        Pipeline() = default;
+        explicit Pipeline(size_t threadCount = 0);
+
+        /**
+         * @brief Constructor selecting the scheduler.
+         * @param scheduler The executor to run queued pads on.
+         * @param threadCount The number of executor threads. `0` selects the
+         *        number of hardware threads.
+         */
+        explicit Pipeline(SchedulerType scheduler, size_t threadCount = 0);
 
         /**
          * @brief Destructor.
@@ -47,22 +78,68 @@ namespace lexus2k::pipeline
         T* addNode(Args&&... args)
         {
             auto node = std::make_shared<T>(std::forward<Args>(args)...);
-            m_nodes.push_back(node);
+            adopt(node);
             return node.get();
         }
 
         /**
          * @brief Adds a lambda-based node to the pipeline.
+         *
+         * A lambda taking `std::shared_ptr<IPacket>` and `IPad&` creates an
+         * `ILambdaNode`. A lambda taking `std::shared_ptr<T>` and `Emit&`
+         * creates a typed `LambdaNode` accepting `T` packets.
+         *
          * @tparam T The type of the lambda function.
          * @param lambda The lambda function to process packets.
-         * @return A pointer to the newly added LambdaNode.
+         * @return A pointer to the newly added node.
          */
-        template <typename T, typename = std::enable_if<std::is_invocable_v<T>>>
-        ILambdaNode<T>* addNode(T&& lambda)
+        template <typename T, typename = std::enable_if_t<std::is_class_v<std::decay_t<T>>>>
+        auto* addNode(T&& lambda)
         {
-            auto node = std::make_shared<ILambdaNode<T>>(lambda);
-            m_nodes.push_back(node);
-            return node.get();
+            if constexpr (std::is_invocable_v<T, std::shared_ptr<IPacket>, IPad&>)
+            {
+                auto node = std::make_shared<ILambdaNode<T>>(lambda);
+                adopt(node);
+                return node.get();
+            }
+            else
+            {
+                auto node = std::make_shared<LambdaNode<std::decay_t<T>>>(std::forward<T>(lambda));
+                adopt(node);
+                return node.get();
+            }
+        }
+
+        /**
+         * @brief Adds `count` replicas of a node and a dispatcher spreading
+         *        packets across them.
+         *
+         * Every replica is constructed from copies of `args`. Output `i` of
+         * the dispatcher is connected to the `"input"` pad of replica `i`, if
+         * the replica has one; otherwise the caller connects the replicas.
+         * Give the replicas queued input pads so that they run in parallel on
+         * the executor. The dispatcher uses round-robin order by default, see
+         * `Dispatcher::setPolicy()`.
+         *
+         * @tparam T The type of the replicated node.
+         * @param count The number of replicas.
+         * @param args Arguments for the constructor of every replica.
+         * @return The dispatcher and the replicas.
+         */
+        template <typename T, typename... Args>
+        ReplicaGroup<T> addReplicated(size_t count, const Args&... args)
+        {
+            ReplicaGroup<T> group{addNode<Dispatcher>(count), {}};
+            for (size_t i = 0; i < count; i++)
+            {
+                T* replica = addNode<T>(args...);
+                group.replicas.push_back(replica);
+                if (IPad* input = replica->getPadByName("input", PadType::INPUT))
+                {
+                    connect(*group.dispatcher->getPadByName("output_" + std::to_string(i + 1)), *input);
+                }
+            }
+            return group;
         }
 
         /**
@@ -75,18 +152,104 @@ namespace lexus2k::pipeline
             output.then(input);
         }
 
+        /**
+         * @brief Connects a typed output pad to a typed input pad.
+         *
+         * Fails to compile if packets of type `T` are not accepted by the
+         * input pad. Packets sent through the connection reach the consumer
+         * without any runtime type check.
+         *
+         * @param output The output pad.
+         * @param input The input pad.
+         */
+        template <typename T, typename U, typename Base>
+        void connect(OutputPad<T>& output, InputPad<U, Base>& input) const noexcept
+        {
+            output.then(input);
+        }
+
+        /**
+         * @brief Validates the graph and prepares it for running.
+         *
+         * Computes a topological order of the nodes, the output table of
+         * every node and the route of every output pad, and records output
+         * pads without a link and cycles. Called by `start()`.
+         *
+         * @return `false` if a single-producer pad has several upstream links,
+         *         or, in strict mode, if there are dangling outputs or cycles.
+         */
+        bool compile() noexcept;
+
         /**
          * @brief Starts all nodes in the pipeline.
+         *
+         * Compiles the graph, then starts the nodes in reverse topological
+         * order, so that consumers are ready before their producers emit.
          */
         bool start() noexcept;
 
         /**
-         * @brief Stops all nodes in the pipeline.
+         * @brief Stops all nodes in the pipeline, producers first.
          */
         void stop() noexcept;
 
+        /**
+         * @brief Makes `compile()` fail on dangling outputs and cycles.
+         * @param strict `true` to reject such graphs, `false` to only report them.
+         */
+        void setStrict(bool strict) noexcept { m_isStrict = strict; }
+
+        /**
+         * @brief Gets the output pads found without a link by the last `compile()`.
+         */
+        const std::vector<const IPad*>& danglingOutputs() const noexcept { return m_danglingOutputs; }
+
+        /**
+         * @brief Tells whether the last `compile()` found a cycle.
+         */
+        bool hasCycles() const noexcept { return m_hasCycles; }
+
+        /**
+         * @brief Gets the nodes in topological order, as computed by the last
+         *        `compile()`. Nodes on cycles come last, in insertion order.
+         */
+        const std::vector<INode*>& order() const noexcept { return m_order; }
+
+        /**
+         * @brief Gets the executor shared by the nodes of the pipeline.
+         */
+        IExecutor& executor() const noexcept { return *m_executor; }
+
     private:
+        std::atomic<uint64_t> m_linkScope{1}; ///< Link generation of the nodes, outlives them.
         std::vector<std::shared_ptr<INode>> m_nodes; ///< Collection of nodes in the pipeline.
+        std::unique_ptr<IExecutor> m_executor; ///< Thread pool for queued pads.
+        std::vector<INode*> m_order; ///< Nodes in topological order.
+        std::vector<const IPad*> m_danglingOutputs; ///< Output pads without a link.
+        bool m_hasCycles = false; ///< Set if the graph has a cycle.
+        bool m_isStrict = false; ///< Reject dangling outputs and cycles.
+
+        /**
+         * @brief Takes ownership of a node and moves it to the link scope of
+         *        the pipeline, so that relinks elsewhere keep its routes valid.
+         * @param node The node to add.
+         */
+        void adopt(std::shared_ptr<INode> node);
+
+        /**
+         * @brief Checks that every pad's producer constraints hold.
+         * @return `false` if a single-producer pad has several upstream links.
+         */
+        bool validateLinks() const noexcept;
+
+        /**
+         * @brief Follows a link through chained output pads.
+         * @param pad The output pad.
+         * @param maxHops The number of pads after which the chain must be a loop.
+         * @return The input pad packets end up in, or `nullptr` if the chain
+         *         ends without one.
+         */
+        IPad* resolveRoute(const IPad& pad, size_t maxHops) const noexcept;
     };
 
 } // namespace lexus2k::pipeline
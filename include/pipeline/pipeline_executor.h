@@ -0,0 +1,463 @@
+#ifndef LEXUS2K_PIPELINE_EXECUTOR_H
+#define LEXUS2K_PIPELINE_EXECUTOR_H
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "pipeline_ring.h"
+
+namespace lexus2k::pipeline
+{
+    /**
+     * @class ITask
+     * @brief A unit of work that can be scheduled on an `IExecutor`.
+     *
+     * Tasks are referenced, not owned, by the executor. The owner must keep
+     * the task alive until it has run.
+     */
+    class ITask
+    {
+    public:
+        /**
+         * @brief Virtual destructor.
+         */
+        virtual ~ITask() = default;
+
+        /**
+         * @brief Runs the task on one of the executor threads.
+         */
+        virtual void run() noexcept = 0;
+    };
+
+    /**
+     * @enum SchedulerType
+     * @brief Selects the executor a `Pipeline` creates.
+     */
+    enum class SchedulerType
+    {
+        SHARED_QUEUE,  ///< `Executor`: a thread pool fed by one shared queue.
+        WORK_STEALING, ///< `WorkStealingExecutor`: per-worker deques with stealing.
+    };
+
+    /**
+     * @class IExecutor
+     * @brief Runs scheduled tasks on a pool of worker threads.
+     */
+    class IExecutor
+    {
+    public:
+        /**
+         * @brief Virtual destructor.
+         */
+        virtual ~IExecutor() = default;
+
+        /**
+         * @brief Allows tasks to be scheduled.
+         */
+        virtual bool start() noexcept = 0;
+
+        /**
+         * @brief Stops and joins the worker threads.
+         *
+         * Tasks that have not run yet are discarded.
+         */
+        virtual void stop() noexcept = 0;
+
+        /**
+         * @brief Tells whether the executor accepts tasks.
+         */
+        virtual bool isRunning() const noexcept = 0;
+
+        /**
+         * @brief Schedules a task to run once on a worker thread.
+         * @param task The task to run.
+         * @return `false` if the executor is not running.
+         */
+        virtual bool schedule(ITask& task) noexcept = 0;
+
+        /**
+         * @brief Schedules a task to run once on a worker thread, not before
+         *        the given time.
+         *
+         * The task waits in a timer queue and is handed to `schedule` when
+         * it is due, so waiting for it costs no worker.
+         *
+         * @param task The task to run.
+         * @param when The earliest time to run the task.
+         * @return `false` if the executor is not running.
+         */
+        virtual bool scheduleAt(ITask& task, std::chrono::steady_clock::time_point when) noexcept = 0;
+
+        /**
+         * @brief Removes a task scheduled with `scheduleAt` that is not due yet.
+         * @param task The task.
+         * @return `true` if the task was removed, `false` if it was not
+         *         waiting, for instance because it is queued or running.
+         */
+        virtual bool cancel(ITask& task) noexcept = 0;
+
+        /**
+         * @brief Returns the number of worker threads of the pool.
+         */
+        virtual size_t threadCount() const noexcept = 0;
+
+        /**
+         * @brief Creates an executor of the given type.
+         * @param type The scheduler to use.
+         * @param threadCount The number of worker threads. `0` selects the
+         *        number of hardware threads.
+         */
+        static std::unique_ptr<IExecutor> create(SchedulerType type, size_t threadCount = 0);
+    };
+
+    /**
+     * @class TaskHandoff
+     * @brief Keeps at most one instance of a task queued or running.
+     *
+     * Producers call `schedule` after publishing work for the task. The task
+     * calls `finish` as the last thing in `run`: it gives up the task, then
+     * checks for work that slipped in meanwhile and reschedules itself, since
+     * a producer that found the task still scheduled did not. Owners call
+     * `wait` when stopping, until the task is neither queued nor running.
+     */
+    class TaskHandoff
+    {
+    public:
+        /**
+         * @brief Schedules the task unless it is already queued or running.
+         * @param executor The executor to run the task on.
+         * @param task The task.
+         * @return `false` if the executor rejected the task.
+         */
+        bool schedule(IExecutor& executor, ITask& task) noexcept
+        {
+            if (m_isScheduled.exchange(true, std::memory_order_acq_rel))
+            {
+                return true; // Queued or running: it will see the new work
+            }
+            if (executor.schedule(task))
+            {
+                return true;
+            }
+            m_isScheduled.store(false, std::memory_order_release);
+            m_isScheduled.notify_all();
+            return false;
+        }
+
+        /**
+         * @brief Gives up the task at the end of its `run`, rescheduling it
+         *        if work is left.
+         * @param executor The executor the task runs on.
+         * @param task The task.
+         * @param hasWork Tells whether work is left. Called after the task
+         *        was given up, so that work published meanwhile is seen.
+         */
+        template <typename HasWork>
+        void finish(IExecutor& executor, ITask& task, HasWork&& hasWork) noexcept
+        {
+            // The exchange synchronizes with the producer that last set the flag
+            m_isScheduled.exchange(false, std::memory_order_acq_rel);
+            if (hasWork() && !m_isScheduled.exchange(true, std::memory_order_acq_rel))
+            {
+                if (executor.schedule(task))
+                {
+                    return;
+                }
+                m_isScheduled.store(false, std::memory_order_release);
+            }
+            m_isScheduled.notify_all();
+        }
+
+        /**
+         * @brief Schedules the task for a later time unless it is already
+         *        queued, waiting or running.
+         * @param executor The executor to run the task on.
+         * @param task The task.
+         * @param when The earliest time to run the task.
+         * @return `false` if the executor rejected the task.
+         */
+        bool scheduleAt(IExecutor& executor, ITask& task, std::chrono::steady_clock::time_point when) noexcept
+        {
+            if (m_isScheduled.exchange(true, std::memory_order_acq_rel))
+            {
+                return true;
+            }
+            if (executor.scheduleAt(task, when))
+            {
+                return true;
+            }
+            m_isScheduled.store(false, std::memory_order_release);
+            m_isScheduled.notify_all();
+            return false;
+        }
+
+        /**
+         * @brief Gives up the task at the end of its `run`, rescheduling it
+         *        for the time it is next needed.
+         * @param executor The executor the task runs on.
+         * @param task The task.
+         * @param nextRun Returns when the task must run again, or
+         *        `time_point::max()` if it has nothing left to do. Called
+         *        after the task was given up.
+         */
+        template <typename NextRun>
+        void finishAt(IExecutor& executor, ITask& task, NextRun&& nextRun) noexcept
+        {
+            m_isScheduled.exchange(false, std::memory_order_acq_rel);
+            auto when = nextRun();
+            if (when != std::chrono::steady_clock::time_point::max() &&
+                !m_isScheduled.exchange(true, std::memory_order_acq_rel))
+            {
+                if (executor.scheduleAt(task, when))
+                {
+                    return;
+                }
+                m_isScheduled.store(false, std::memory_order_release);
+            }
+            m_isScheduled.notify_all();
+        }
+
+        /**
+         * @brief Takes back a task waiting for its time, so that stopping
+         *        does not wait for the timer.
+         * @param executor The executor the task was scheduled on.
+         * @param task The task.
+         */
+        void cancel(IExecutor& executor, ITask& task) noexcept
+        {
+            if (executor.cancel(task))
+            {
+                m_isScheduled.store(false, std::memory_order_release);
+                m_isScheduled.notify_all();
+            }
+        }
+
+        /**
+         * @brief Waits until the task is neither queued nor running.
+         */
+        void wait() const noexcept
+        {
+            while (m_isScheduled.load(std::memory_order_acquire))
+            {
+                m_isScheduled.wait(true, std::memory_order_acquire);
+            }
+        }
+
+        /**
+         * @brief Forgets a task discarded by a stopped executor.
+         */
+        void reset() noexcept { m_isScheduled.store(false, std::memory_order_relaxed); }
+
+    private:
+        std::atomic_bool m_isScheduled{false}; ///< Set while the task is queued or running.
+    };
+
+    /**
+     * @class TimerQueue
+     * @brief Holds tasks until they are due and then schedules them on an executor.
+     *
+     * One helper thread, created on the first timed task, sleeps until the
+     * earliest task is due. Executors own a timer queue to implement
+     * `IExecutor::scheduleAt`.
+     */
+    class TimerQueue
+    {
+    public:
+        /**
+         * @brief Constructor.
+         * @param executor The executor due tasks are scheduled on.
+         */
+        explicit TimerQueue(IExecutor& executor) : m_executor(executor) {}
+
+        TimerQueue(const TimerQueue&) = delete;
+        TimerQueue& operator=(const TimerQueue&) = delete;
+
+        /**
+         * @brief Destructor. Stops the helper thread.
+         */
+        ~TimerQueue() { stop(); }
+
+        /**
+         * @brief Adds a task to run at the given time.
+         */
+        void add(ITask& task, std::chrono::steady_clock::time_point when) noexcept;
+
+        /**
+         * @brief Removes a task that is not due yet.
+         * @return `true` if the task was removed.
+         */
+        bool cancel(ITask& task) noexcept;
+
+        /**
+         * @brief Discards the waiting tasks and joins the helper thread.
+         */
+        void stop() noexcept;
+
+    private:
+        IExecutor& m_executor; ///< The executor due tasks are scheduled on.
+        std::mutex m_mutex; ///< Protects the waiting tasks.
+        std::condition_variable m_changed; ///< Signals a new earliest task or stopping.
+        std::multimap<std::chrono::steady_clock::time_point, ITask*> m_tasks; ///< Waiting tasks by due time.
+        std::thread m_thread; ///< The helper thread.
+        bool m_isStopping = false; ///< Tells the helper thread to exit.
+
+        void threadBody() noexcept;
+    };
+
+    /**
+     * @class Executor
+     * @brief A fixed pool of worker threads fed by a single shared queue.
+     *
+     * Instead of running one thread per queued pad, queued pads schedule
+     * themselves on the executor whenever they have work. The worker threads
+     * are created on the first scheduled task, so a pipeline without queued
+     * pads does not pay for them.
+     */
+    class Executor : public IExecutor
+    {
+    public:
+        /**
+         * @brief Constructs the executor.
+         * @param threadCount The number of worker threads. `0` selects the
+         *        number of hardware threads.
+         */
+        explicit Executor(size_t threadCount = 0);
+
+        Executor(const Executor&) = delete;
+        Executor& operator=(const Executor&) = delete;
+
+        /**
+         * @brief Destructor. Stops the worker threads.
+         */
+        ~Executor() override;
+
+        bool start() noexcept override;
+
+        void stop() noexcept override;
+
+        bool isRunning() const noexcept override;
+
+        bool schedule(ITask& task) noexcept override;
+
+        bool scheduleAt(ITask& task, std::chrono::steady_clock::time_point when) noexcept override;
+
+        bool cancel(ITask& task) noexcept override { return m_timers.cancel(task); }
+
+        size_t threadCount() const noexcept override { return m_threadCount; }
+
+    private:
+        size_t m_threadCount; ///< Size of the pool.
+        TimerQueue m_timers{*this}; ///< Tasks scheduled for later.
+        mutable std::mutex m_mutex; ///< Protects the task queue.
+        std::condition_variable m_hasTasks; ///< Signals queued tasks.
+        std::deque<ITask*> m_tasks; ///< Tasks waiting for a worker.
+        std::vector<std::thread> m_threads; ///< The worker threads.
+        bool m_isRunning = false; ///< Whether tasks are accepted.
+
+        void threadBody() noexcept;
+    };
+
+    /**
+     * @class WorkStealingExecutor
+     * @brief A fixed pool of worker threads with per-worker deques and stealing.
+     *
+     * Each worker owns a bounded Chase-Lev deque. A task scheduled from a
+     * worker thread, typically a downstream pad woken up by its producer, is
+     * pushed onto that worker's deque and popped LIFO, so it tends to run on
+     * the same core while the packet is still in cache. Tasks scheduled from
+     * other threads go through a shared injection queue. Idle workers steal
+     * the oldest tasks from the other workers' deques, which evens out skewed
+     * load, and only sleep when there is nothing to run or steal.
+     *
+     * With either executor, a task blocked on a full downstream pad holds its
+     * worker, so a chain of blocking pads needs more workers than pads.
+     */
+    class WorkStealingExecutor : public IExecutor
+    {
+    public:
+        /**
+         * @brief Constructs the executor.
+         * @param threadCount The number of worker threads. `0` selects the
+         *        number of hardware threads.
+         */
+        explicit WorkStealingExecutor(size_t threadCount = 0);
+
+        WorkStealingExecutor(const WorkStealingExecutor&) = delete;
+        WorkStealingExecutor& operator=(const WorkStealingExecutor&) = delete;
+
+        /**
+         * @brief Destructor. Stops the worker threads.
+         */
+        ~WorkStealingExecutor() override;
+
+        bool start() noexcept override;
+
+        void stop() noexcept override;
+
+        bool isRunning() const noexcept override;
+
+        bool schedule(ITask& task) noexcept override;
+
+        bool scheduleAt(ITask& task, std::chrono::steady_clock::time_point when) noexcept override;
+
+        bool cancel(ITask& task) noexcept override { return m_timers.cancel(task); }
+
+        size_t threadCount() const noexcept override { return m_workers.size(); }
+
+    private:
+        /**
+         * @brief Bounded Chase-Lev deque. The owner pushes and pops at the
+         *        bottom, thieves take from the top.
+         */
+        class TaskDeque
+        {
+        public:
+            static constexpr int64_t Capacity = 256;
+
+            bool push(ITask* task) noexcept;
+            ITask* pop() noexcept;
+            ITask* steal() noexcept;
+            bool empty() const noexcept;
+            void clear() noexcept;
+
+        private:
+            alignas(CacheLineSize) std::atomic<int64_t> m_top{0}; ///< Next task to steal.
+            alignas(CacheLineSize) std::atomic<int64_t> m_bottom{0}; ///< Next free slot of the owner.
+            std::atomic<ITask*> m_tasks[Capacity] = {}; ///< Task slots.
+        };
+
+        struct Worker
+        {
+            TaskDeque deque; ///< Local tasks of the worker.
+            std::thread thread; ///< The worker thread.
+        };
+
+        std::vector<std::unique_ptr<Worker>> m_workers; ///< The pool.
+        mutable std::mutex m_mutex; ///< Protects the injection queue and thread creation.
+        std::deque<ITask*> m_injected; ///< Tasks scheduled from outside the pool.
+        std::atomic_bool m_hasInjected{false}; ///< Hint that the injection queue is not empty.
+        std::atomic_bool m_isRunning{false}; ///< Whether tasks are accepted.
+        std::atomic<uint32_t> m_sleepers{0}; ///< Number of sleeping workers.
+        std::atomic<uint32_t> m_wakeups{0}; ///< Wake-up counter sleeping workers wait on.
+        bool m_threadsStarted = false; ///< Whether the worker threads exist.
+        TimerQueue m_timers{*this}; ///< Tasks scheduled for later.
+
+        ITask* findTask(size_t index) noexcept;
+        ITask* takeInjected() noexcept;
+        bool hasWork() const noexcept;
+        void wakeWorker() noexcept;
+        void threadBody(size_t index) noexcept;
+    };
+
+} // namespace lexus2k::pipeline
+
+#endif // LEXUS2K_PIPELINE_EXECUTOR_H
@@ -3,7 +3,11 @@
 
 #include <vector>
 #include <memory>
+#include <span>
 #include <string>
+#include <unordered_map>
+#include <type_traits>
+#include <utility>
 
 #include "pipeline_pad.h"
 #include "pipeline_pads.h"
@@ -13,6 +17,45 @@ namespace lexus2k::pipeline
 {
     class Pipeline;
 
+    /**
+     * @class PadId
+     * @brief A handle to a pad of a node, resolved in constant time.
+     *
+     * Pad ids are looked up by name once, with `INode::padId`, typically
+     * when a node is set up. Pushing through a pad id does not touch any
+     * string on the packet path.
+     */
+    class PadId
+    {
+    public:
+        /**
+         * @brief Constructs an invalid pad id.
+         */
+        constexpr PadId() noexcept = default;
+
+        /**
+         * @brief Constructs a pad id from the index of a pad in its node.
+         */
+        constexpr explicit PadId(size_t index) noexcept : m_index(index) {}
+
+        /**
+         * @brief Gets the index of the pad in its node.
+         */
+        constexpr size_t index() const noexcept { return m_index; }
+
+        /**
+         * @brief Tells whether the id refers to a pad.
+         */
+        constexpr explicit operator bool() const noexcept { return m_index != Invalid; }
+
+        constexpr bool operator==(const PadId&) const noexcept = default;
+
+    private:
+        static constexpr size_t Invalid = static_cast<size_t>(-1);
+
+        size_t m_index = Invalid; ///< Index of the pad in its node.
+    };
+
     /**
      * @class INode
      * @brief Represents a node in the pipeline, managing pads and processing packets.
@@ -49,6 +92,27 @@ namespace lexus2k::pipeline
          */
         bool pushPacket(const std::string& name, std::shared_ptr<IPacket> packet, uint32_t timeout = 0) const noexcept;
 
+        /**
+         * @brief Pushes a packet to a pad by id.
+         *
+         * Unlike the name-based overload, the pad may be an input or an
+         * output pad: sources push to their own outputs this way.
+         *
+         * @param id The id of the pad, as returned by `padId`.
+         * @param packet The packet to push.
+         * @param timeout The timeout for the operation.
+         * @return True if the packet was successfully pushed, false otherwise.
+         */
+        bool pushPacket(PadId id, std::shared_ptr<IPacket> packet, uint32_t timeout = 0) const noexcept;
+
+        /**
+         * @brief Looks up the id of a pad by name.
+         * @param name The name of the pad.
+         * @param type The type of the pad, or `PadType::UNDEFINED` for any type.
+         * @return The id of the pad, or an invalid id if there is no such pad.
+         */
+        PadId padId(const std::string& name, PadType type = PadType::UNDEFINED) const noexcept;
+
         /**
          * @brief Adds a new input pad to the node.
          * @tparam T The type of the pad.
@@ -60,10 +124,7 @@ namespace lexus2k::pipeline
         T& addInput(const std::string& name, Args&&... args)
         {
             auto pad = std::make_shared<T>(std::forward<Args>(args)...);
-            pad->setType(PadType::INPUT);
-            pad->setParent(this);
-            m_pads.emplace_back(name, pad);
-            pad->setIndex(m_pads.size() - 1);
+            addPad(name, pad, PadType::INPUT);
             return *pad;
         }
 
@@ -79,6 +140,21 @@ namespace lexus2k::pipeline
             return addInput<SimplePad>(name, std::forward<Args>(args)...);
         }
 
+        /**
+         * @brief Adds a new output pad of a given type to the node.
+         * @tparam T The type of the pad, for instance `OutputPad<P>`.
+         * @param name The name of the pad.
+         * @param args Additional arguments for the pad's constructor.
+         * @return A reference to the newly added pad.
+         */
+        template <typename T, typename... Args>
+        T& addOutput(const std::string& name, Args&&... args)
+        {
+            auto pad = std::make_shared<T>(std::forward<Args>(args)...);
+            addPad(name, pad, PadType::OUTPUT);
+            return *pad;
+        }
+
         /**
          * @brief Adds a new output pad to the node.
          * @param name The name of the pad.
@@ -86,12 +162,7 @@ namespace lexus2k::pipeline
          */
         auto& addOutput(const std::string &name)
         {
-            auto pad = std::make_shared<SimplePad>();
-            pad->setType(PadType::OUTPUT);
-            pad->setParent(this);
-            m_pads.emplace_back(name, pad);
-            pad->setIndex(m_pads.size() - 1);
-            return *pad;
+            return addOutput<SimplePad>(name);
         }
 
         /**
@@ -110,6 +181,58 @@ namespace lexus2k::pipeline
          */
         IPad& operator[](size_t index) const;
 
+        /**
+         * @brief Retrieves a pad by id.
+         * @param id The id of the pad.
+         * @return A reference to the pad.
+         * @throws std::runtime_error if the pad is not found.
+         */
+        IPad& operator[](PadId id) const { return (*this)[id.index()]; }
+
+        /**
+         * @brief Gets the executor shared by the pipeline the node belongs to.
+         * @return A pointer to the executor, or `nullptr` if the node is not
+         *         started by a `Pipeline`.
+         */
+        IExecutor* executor() const noexcept { return m_executor; }
+
+        /**
+         * @brief Gets the output pads of the node, in the order they were added.
+         *
+         * The list grows with `addOutput()`, so it is complete for nodes used
+         * on their own as well as in a `Pipeline`. Nodes can use it as their
+         * routing table on the packet path.
+         */
+        const std::vector<IPad*>& outputs() const noexcept { return m_outputs; }
+
+        /**
+         * @brief Gets the number of packets the node could emit right now
+         *        without blocking.
+         *
+         * The default is the smallest headroom of the linked output pads,
+         * since a node may send a packet to each of them; nodes that send
+         * every packet to one output only override it. Outputs without a
+         * link are skipped, unless none of the outputs has one, which makes
+         * the headroom `0`. Synchronous input pads
+         * report this value to their producers, so the headroom propagates
+         * upstream through chains of synchronous nodes. Like
+         * `IPad::headroom()`, it is a snapshot and reserves nothing.
+         *
+         * @param hops The number of pads and nodes already walked by the query.
+         * @return The number of packets, `SIZE_MAX` for a node without outputs.
+         */
+        virtual size_t headroom(size_t hops = 0) const noexcept;
+
+        /**
+         * @brief Tells whether the node can emit packets without blocking.
+         *
+         * Sources call it before building a packet, to slow down or take a
+         * cheaper path while the consumers are overloaded.
+         *
+         * @param count The number of packets to emit.
+         */
+        bool canEmit(size_t count = 1) const noexcept { return headroom() >= count; }
+
         /**
          * @brief Starts the node.
          *
@@ -151,11 +274,43 @@ namespace lexus2k::pipeline
          */
         virtual bool processPacket(std::shared_ptr<IPacket> packet, IPad& inputPad, uint32_t timeoutMs) noexcept { return false; }
 
+        /**
+         * @brief Processes a batch of packets received on an input pad.
+         *
+         * Queued pads configured with a batch size greater than one drain up to
+         * that many packets at once and hand them over through this method.
+         * Nodes doing vectorizable work can override it to amortize per-packet
+         * overhead. The default implementation calls `processPacket` for every
+         * packet in order.
+         *
+         * @param packets The packets to process, oldest first.
+         * @param inputPad The input pad that received the packets.
+         * @param timeoutMs The timeout for the operation.
+         * @return True if all packets were successfully processed, false otherwise.
+         */
+        virtual bool processBatch(std::span<std::shared_ptr<IPacket>> packets, IPad& inputPad, uint32_t timeoutMs) noexcept
+        {
+            bool result = true;
+            for (auto& packet: packets)
+            {
+                result = processPacket(std::move(packet), inputPad, timeoutMs) && result;
+            }
+            return result;
+        }
+
         // Helper method to find a pad by name
         IPad* getPadByName(const std::string& name, PadType type = PadType::UNDEFINED) const noexcept;
 
         IPad* getPadByIndex(size_t index) const noexcept;
 
+        /**
+         * @brief Registers a new pad under a name.
+         * @param name The name of the pad.
+         * @param pad The pad.
+         * @param type The type of the pad.
+         */
+        void addPad(const std::string& name, std::shared_ptr<IPad> pad, PadType type);
+
         /**
          * @brief Starts the node. It guarantees that if any pad start fails,
          *        node will not be started
@@ -170,6 +325,12 @@ namespace lexus2k::pipeline
 
     private:
         std::vector<std::pair<std::string, std::shared_ptr<IPad>>> m_pads; ///< Collection of pads.
+        std::unordered_multimap<std::string, size_t> m_padNames; ///< Pad indices by name.
+        IExecutor* m_executor = nullptr; ///< Executor of the owning pipeline.
+        std::vector<IPad*> m_outputs; ///< Output pads, in the order they were added.
+        std::atomic<uint64_t>* m_linkScope = &s_linkScope; ///< Link generation of the owning pipeline.
+
+        static inline std::atomic<uint64_t> s_linkScope{1}; ///< Link generation of nodes used on their own.
 
         friend class IPad;
         friend class Pipeline;
@@ -181,9 +342,10 @@ namespace lexus2k::pipeline
      *
      * The `Node` class is a specialized implementation of `INode` that provides
      * functionality for processing packets of a specific type derived from `IPacket`.
-     * It uses `std::dynamic_pointer_cast` to safely cast incoming packets to the
+     * It uses `packet_cast` to safely cast incoming packets to the
      * specified type and delegates the processing to a type-specific `processPacket`
-     * method.
+     * method. Packet types derived from `Packet<T>` are matched with a single
+     * compare of their type tag, which also works without RTTI.
      *
      * @tparam T The type of the packet to process. Must be derived from `IPacket`.
      */
@@ -214,7 +376,7 @@ namespace lexus2k::pipeline
          *
          * This method overrides the `processPacket` method in the `INode` base
          * class. It attempts to cast the incoming packet to the specified type
-         * `T` using `std::dynamic_pointer_cast`. If the cast is successful, it
+         * `T` using `packet_cast`. If the cast is successful, it
          * delegates the processing to the type-specific `processPacket` method.
          *
          * @param packet The packet to process, as a shared pointer to `IPacket`.
@@ -222,11 +384,15 @@ namespace lexus2k::pipeline
          */
         bool processPacket(std::shared_ptr<IPacket> packet, IPad& inputPad, uint32_t timeoutMs) noexcept override final
         {
-            // TODO: Make 2 implementations with RTTI support and without
-            auto derivedPacket = std::dynamic_pointer_cast<T>(packet);
+            if (inputPad.packetKey() == packetTypeKey<T>())
+            {
+                // A typed input pad only lets `T` packets through
+                return processPacket(std::static_pointer_cast<T>(std::move(packet)), inputPad, timeoutMs);
+            }
+            auto derivedPacket = packet_cast<T>(std::move(packet));
             if (derivedPacket)
             {
-                return processPacket(derivedPacket, inputPad, timeoutMs);
+                return processPacket(std::move(derivedPacket), inputPad, timeoutMs);
             }
             return false; // Packet type mismatch
         }
@@ -244,96 +410,151 @@ namespace lexus2k::pipeline
         virtual bool processPacket(std::shared_ptr<T> packet, IPad& inputPad, uint32_t timeoutMs) noexcept = 0;
     };
 
+    template <typename Indices, typename... Ts>
+    class BasicNodeN;
+
     /**
-     * @class Node2
-     * @brief A template class for processing packets of two types derived from `IPacket`.
-     *
-     * The `Node2` class is a specialized implementation of `INode` that provides
-     * functionality for processing packets of two specific types derived from `IPacket`.
-     * It uses `std::dynamic_pointer_cast` to safely cast incoming packets to the
-     * specified types (`T1` or `T2`) and delegates the processing to type-specific
-     * `processPacket` methods.
+     * @class NodeSlot
+     * @brief The per-type processing method of a `NodeN` input.
      *
-     * @tparam T1 The first type of the packet to process. Must be derived from `IPacket`.
-     * @tparam T2 The second type of the packet to process. Must be derived from `IPacket`.
+     * @tparam Index The index of the input pad.
+     * @tparam T The packet type accepted on that pad.
      */
-    template <typename T1, typename T2, typename = std::enable_if_t<std::is_base_of_v<IPacket, T1> && std::is_base_of_v<IPacket, T2>>>
-    class Node2 : public INode
+    template <size_t Index, typename T>
+    class NodeSlot
     {
     public:
-        /**
-         * @brief Default constructor.
-         *
-         * Initializes the `Node2` instance. This constructor does not perform
-         * any specific initialization beyond the base class constructor.
-         */
-        Node2() : INode() {}
+        virtual ~NodeSlot() = default;
 
+    protected:
         /**
-         * @brief Default destructor.
+         * @brief Processes a packet received on input pad `Index`.
          *
-         * Ensures proper cleanup of the `Node2` instance. This destructor is
-         * defaulted and does not perform any specific cleanup beyond the base
-         * class destructor.
+         * @param packet The packet to process, as a shared pointer to `T`.
+         * @param inputPad The input pad that received the packet.
+         * @param timeoutMs The timeout for the operation.
          */
-        ~Node2() = default;
+        virtual bool processPacket(std::shared_ptr<T> packet, IPad& inputPad, uint32_t timeoutMs) noexcept = 0;
+
+        template <typename Indices, typename... Ts>
+        friend class BasicNodeN;
+    };
+
+    /**
+     * @class BasicNodeN
+     * @brief Implementation of `NodeN` over an index sequence.
+     */
+    template <size_t... Is, typename... Ts>
+    class BasicNodeN<std::index_sequence<Is...>, Ts...> : public INode, public NodeSlot<Is, Ts>...
+    {
+        static_assert((std::is_base_of_v<IPacket, Ts> && ...), "NodeN packet types must be derived from IPacket");
 
     protected:
+        using NodeSlot<Is, Ts>::processPacket...;
+
         /**
          * @brief Processes a packet received on an input pad.
          *
-         * This method overrides the `processPacket` method in the `INode` base
-         * class. It determines the type of the incoming packet based on the
-         * index of the input pad. If the input pad index is `0`, it attempts
-         * to cast the packet to type `T1`. If the input pad index is `1`, it
-         * attempts to cast the packet to type `T2`. If the cast is successful,
-         * it delegates the processing to the corresponding type-specific
-         * `processPacket` method.
+         * The index of the input pad selects an entry of a jump table built at
+         * compile time. The entry casts the packet to the type of that pad
+         * with `packet_cast` and calls the matching `processPacket` overload.
          *
          * @param packet The packet to process, as a shared pointer to `IPacket`.
          * @param inputPad The input pad that received the packet.
          */
         bool processPacket(std::shared_ptr<IPacket> packet, IPad& inputPad, uint32_t timeoutMs) noexcept override final
         {
-            if (inputPad.getIndex() == 0) {
-                auto derivedPacket = std::dynamic_pointer_cast<T1>(packet);
-                if (derivedPacket)
-                {
-                    return processPacket(derivedPacket, inputPad, timeoutMs);
-                }
+            size_t index = inputPad.getIndex();
+            if (index >= sizeof...(Ts))
+            {
+                return false; // No packet type for this pad
+            }
+            return s_dispatch[index](*this, std::move(packet), inputPad, timeoutMs);
+        }
+
+    private:
+        using Dispatch = bool (*)(BasicNodeN&, std::shared_ptr<IPacket>&&, IPad&, uint32_t) noexcept;
+
+        template <size_t I, typename T>
+        static bool dispatch(BasicNodeN& node, std::shared_ptr<IPacket>&& packet, IPad& inputPad, uint32_t timeoutMs) noexcept
+        {
+            auto& slot = static_cast<NodeSlot<I, T>&>(node);
+            if (inputPad.packetKey() == packetTypeKey<T>())
+            {
+                // A typed input pad only lets `T` packets through
+                return slot.processPacket(std::static_pointer_cast<T>(std::move(packet)), inputPad, timeoutMs);
             }
-            else if (inputPad.getIndex() == 1)
+            auto derivedPacket = packet_cast<T>(std::move(packet));
+            if (!derivedPacket)
             {
-                auto derivedPacket = std::dynamic_pointer_cast<T2>(packet);
-                if (derivedPacket)
-                {
-                    return processPacket(derivedPacket, inputPad, timeoutMs);
-                }
+                return false; // Packet type mismatch
             }
-            return false; // Packet type mismatch
+            return slot.processPacket(std::move(derivedPacket), inputPad, timeoutMs);
         }
 
+        static constexpr Dispatch s_dispatch[] = {&dispatch<Is, Ts>...}; ///< Handler per input pad index.
+    };
+
+    /**
+     * @class NodeN
+     * @brief A template class for processing packets of several types derived from `IPacket`.
+     *
+     * The `NodeN` class generalizes `Node2` to any number of inputs: a packet
+     * received on input pad `i` is cast to `Ts[i]` and passed to the
+     * `processPacket` overload for that type. Derived classes implement one
+     * overload per packet type. If the same type appears on several pads,
+     * one overload serves all of them and can tell them apart with
+     * `inputPad.getIndex()`.
+     *
+     * @tparam Ts The packet type of each input pad, in pad index order.
+     */
+    template <typename... Ts>
+    class NodeN : public BasicNodeN<std::index_sequence_for<Ts...>, Ts...>
+    {
+    public:
         /**
-         * @brief Processes a packet of the first type (`T1`).
-         *
-         * This method must be implemented by derived classes to provide
-         * type-specific processing logic for packets of type `T1`.
-         *
-         * @param packet The packet to process, as a shared pointer to `T1`.
-         * @param inputPad The input pad that received the packet.
+         * @brief Default constructor.
          */
-        virtual bool processPacket(std::shared_ptr<T1> packet, IPad& inputPad, uint32_t timeoutMs) noexcept = 0;
+        NodeN() = default;
 
         /**
-         * @brief Processes a packet of the second type (`T2`).
+         * @brief Default destructor.
+         */
+        ~NodeN() = default;
+    };
+
+    /**
+     * @class Node2
+     * @brief A template class for processing packets of two types derived from `IPacket`.
+     *
+     * The `Node2` class is a `NodeN` with two inputs. Packets received on the
+     * input pad with index `0` are processed as `T1`, packets received on the
+     * input pad with index `1` as `T2`. Derived classes implement the two
+     * type-specific `processPacket` methods.
+     *
+     * @tparam T1 The first type of the packet to process. Must be derived from `IPacket`.
+     * @tparam T2 The second type of the packet to process. Must be derived from `IPacket`.
+     */
+    template <typename T1, typename T2, typename = std::enable_if_t<std::is_base_of_v<IPacket, T1> && std::is_base_of_v<IPacket, T2>>>
+    class Node2 : public NodeN<T1, T2>
+    {
+    public:
+        /**
+         * @brief Default constructor.
          *
-         * This method must be implemented by derived classes to provide
-         * type-specific processing logic for packets of type `T2`.
+         * Initializes the `Node2` instance. This constructor does not perform
+         * any specific initialization beyond the base class constructor.
+         */
+        Node2() = default;
+
+        /**
+         * @brief Default destructor.
          *
-         * @param packet The packet to process, as a shared pointer to `T2`.
-         * @param inputPad The input pad that received the packet.
+         * Ensures proper cleanup of the `Node2` instance. This destructor is
+         * defaulted and does not perform any specific cleanup beyond the base
+         * class destructor.
          */
-        virtual bool processPacket(std::shared_ptr<T2> packet, IPad& inputPad, uint32_t timeoutMs) noexcept = 0;
+        ~Node2() = default;
     };
 } // namespace lexus2k::pipeline
 
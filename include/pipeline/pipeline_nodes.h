@@ -1,8 +1,18 @@
 #ifndef LEXUS2K_PIPELINE_NODES_H
 #define LEXUS2K_PIPELINE_NODES_H
 
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <functional>
+#include <map>
 #include <memory>
+#include <mutex>
 #include <string>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
 #include "pipeline_node.h"
 
 namespace lexus2k::pipeline
@@ -30,31 +40,205 @@ namespace lexus2k::pipeline
          */
         bool processPacket(std::shared_ptr<IPacket> packet, IPad& inputPad, uint32_t timeoutMs) noexcept override
         {
-            return m_func(packet, inputPad);
+            return m_func(std::move(packet), inputPad);
         }
 
     private:
         Lambda m_func; ///< The lambda function for processing packets.
     };
 
+    /**
+     * @class Emit
+     * @brief Handle passed to typed lambda nodes to push packets to their outputs.
+     *
+     * The handle is bound to the output pads of the node, in the order they
+     * were added, and to the timeout of the packet being processed.
+     */
+    class Emit
+    {
+    public:
+        /**
+         * @brief Constructor.
+         * @param outputs The output pads of the node.
+         * @param timeout The timeout used for every push, in milliseconds.
+         */
+        Emit(const std::vector<IPad*>& outputs, uint32_t timeout) noexcept : m_outputs(outputs), m_timeout(timeout) {}
+
+        /**
+         * @brief Pushes a packet to the first output pad.
+         * @param packet The packet to push.
+         * @return True if the packet was successfully pushed, false otherwise.
+         */
+        bool operator()(std::shared_ptr<IPacket> packet) const noexcept
+        {
+            return (*this)(size_t(0), std::move(packet));
+        }
+
+        /**
+         * @brief Pushes a packet to an output pad.
+         * @param output The position of the pad among the outputs of the node.
+         * @param packet The packet to push.
+         * @return True if the packet was successfully pushed, false otherwise.
+         */
+        bool operator()(size_t output, std::shared_ptr<IPacket> packet) const noexcept
+        {
+            if (output >= m_outputs.size())
+            {
+                return false; // No such output
+            }
+            return m_outputs[output]->pushPacket(std::move(packet), m_timeout);
+        }
+
+        /**
+         * @brief Returns the number of output pads.
+         */
+        size_t size() const noexcept { return m_outputs.size(); }
+
+        /**
+         * @brief Returns the timeout used for every push.
+         */
+        uint32_t timeout() const noexcept { return m_timeout; }
+
+    private:
+        const std::vector<IPad*>& m_outputs; ///< The output pads of the node.
+        uint32_t m_timeout; ///< The timeout of the packet being processed.
+    };
+
+    /**
+     * @struct LambdaTraits
+     * @brief Deduces the packet type of a typed lambda from its call operator.
+     */
+    template <typename Lambda>
+    struct LambdaTraits : LambdaTraits<decltype(&Lambda::operator())> {};
+
+    template <typename C, typename R, typename T, typename E>
+    struct LambdaTraits<R (C::*)(std::shared_ptr<T>, E)>
+    {
+        using Packet = T; ///< The packet type taken by the lambda.
+    };
+
+    template <typename C, typename R, typename T, typename E>
+    struct LambdaTraits<R (C::*)(std::shared_ptr<T>, E) const> : LambdaTraits<R (C::*)(std::shared_ptr<T>, E)> {};
+
+    template <typename C, typename R, typename T, typename E>
+    struct LambdaTraits<R (C::*)(std::shared_ptr<T>, E) noexcept> : LambdaTraits<R (C::*)(std::shared_ptr<T>, E)> {};
+
+    template <typename C, typename R, typename T, typename E>
+    struct LambdaTraits<R (C::*)(std::shared_ptr<T>, E) const noexcept> : LambdaTraits<R (C::*)(std::shared_ptr<T>, E)> {};
+
+    /**
+     * @class LambdaNode
+     * @brief A node that processes packets of one type with a lambda function.
+     *
+     * The lambda takes `std::shared_ptr<T>` and an `Emit&` handle bound to
+     * the output pads, and returns `bool` or `void`. Packets are dispatched
+     * like in `Node<T>`, so no cast is needed in the lambda. Packets of
+     * another type are rejected.
+     *
+     * @code
+     * auto& node = *pipeline.addNode([](std::shared_ptr<Frame> frame, Emit& emit) {
+     *     return emit(std::make_shared<Thumbnail>(*frame));
+     * });
+     * node.addInput<InputPad<Frame>>("input");
+     * node.addOutput("output");
+     * @endcode
+     *
+     * @tparam Lambda The type of the lambda function.
+     * @tparam T The packet type, deduced from the lambda signature.
+     */
+    template <typename Lambda, typename T = typename LambdaTraits<Lambda>::Packet>
+    class LambdaNode : public Node<T>
+    {
+        static_assert(std::is_invocable_v<Lambda&, std::shared_ptr<T>, Emit&>,
+                      "A typed lambda must take std::shared_ptr<T> and Emit&");
+
+    public:
+        /**
+         * @brief Constructs a LambdaNode with the given lambda function.
+         * @param lambda The lambda function to process packets.
+         */
+        explicit LambdaNode(Lambda lambda) : Node<T>(), m_func(std::move(lambda)) {}
+
+    protected:
+        /**
+         * @brief Processes a packet using the lambda function.
+         * @param packet The packet to process.
+         * @param inputPad The input pad that received the packet.
+         * @param timeoutMs The timeout used for the pushes of the lambda.
+         */
+        bool processPacket(std::shared_ptr<T> packet, IPad& inputPad, uint32_t timeoutMs) noexcept override
+        {
+            Emit emit(this->outputs(), timeoutMs);
+            if constexpr (std::is_void_v<std::invoke_result_t<Lambda&, std::shared_ptr<T>, Emit&>>)
+            {
+                m_func(std::move(packet), emit);
+                return true;
+            }
+            else
+            {
+                return m_func(std::move(packet), emit);
+            }
+        }
+
+    private:
+        Lambda m_func; ///< The lambda function for processing packets.
+    };
+
+    /**
+     * @enum SplitterMode
+     * @brief How a splitter delivers a packet to its outputs.
+     */
+    enum class SplitterMode
+    {
+        SEQUENTIAL, ///< Push to every output in turn on the caller's thread.
+        PARALLEL,   ///< Hand the packet to one delivery task per output.
+    };
+
     /**
      * @class ISplitter
      * @brief A node that forwards packets to multiple output pads.
+     *
+     * In `SplitterMode::SEQUENTIAL` mode the packet is pushed to every output
+     * one after another, and a slow consumer delays the ones after it. In
+     * `SplitterMode::PARALLEL` mode every output gets a bounded lane running
+     * as a task on the pipeline's executor: the producer only pays for the
+     * enqueues, and each lane pushes to its output on its own. A packet that
+     * finds a lane full is dropped for that output only, right away: the
+     * push timeout is not spent waiting for lane space, since that would hold
+     * back the other outputs. It bounds the lane's own push to the output
+     * instead, and a packet the output rejects is dropped as well. Both kinds
+     * of drops are traced as `TraceEvent::DROP` of the lane. Without an
+     * executor the splitter falls back to sequential delivery.
      */
     class ISplitter : public INode
     {
     public:
         /**
-         * @brief Default constructor.
+         * @brief Constructor.
+         * @param mode How packets are delivered to the outputs.
+         * @param laneCapacity The number of packets buffered per output in parallel mode.
          */
-        explicit ISplitter() : INode() {};
+        explicit ISplitter(SplitterMode mode = SplitterMode::SEQUENTIAL, size_t laneCapacity = 64);
 
         /**
          * @brief Default destructor.
          */
-        virtual ~ISplitter() = default;
+        virtual ~ISplitter();
 
     protected:
+        /**
+         * @brief Builds the delivery lanes in parallel mode.
+         */
+        bool start() noexcept override;
+
+        /**
+         * @brief Waits for the delivery lanes to finish and drops the packets left in them.
+         *
+         * The lanes themselves are kept until the next `start`, since a lane
+         * task may still touch its lane right after the wait.
+         */
+        void stop() noexcept override;
+
         /**
          * @brief Processes a packet and forwards it to all output pads.
          * @param packet The packet to process.
@@ -63,13 +247,24 @@ namespace lexus2k::pipeline
          * @return True if the packet was successfully processed, false otherwise.
          */
         bool processPacket(std::shared_ptr<IPacket> packet, IPad& inputPad, uint32_t timeoutMs) noexcept override;
+
+    private:
+        class Lane;
+
+        SplitterMode m_mode; ///< How packets are delivered to the outputs.
+        size_t m_laneCapacity; ///< The number of packets buffered per lane.
+        std::vector<std::unique_ptr<Lane>> m_lanes; ///< One delivery lane per output in parallel mode.
     };
 
     template<size_t N, typename InputPad, typename... Args>
     class Splitter : public ISplitter
     {
     public:
-        explicit Splitter() : ISplitter() {
+        /**
+         * @brief Constructor.
+         * @param mode How packets are delivered to the outputs.
+         */
+        explicit Splitter(SplitterMode mode = SplitterMode::SEQUENTIAL) : ISplitter(mode) {
             addInput<InputPad>("input", Args()...);
             for (size_t i = 1; i <= N; ++i) {
                 addOutput("output_" + std::to_string(i));
@@ -82,6 +277,528 @@ namespace lexus2k::pipeline
         ~Splitter() = default;
     };
 
+    /**
+     * @enum MergePolicy
+     * @brief The order in which a merger takes packets from its inputs.
+     */
+    enum class MergePolicy
+    {
+        ROUND_ROBIN, ///< One packet from each non-empty input in turn.
+        PRIORITY,    ///< Always the lowest-numbered non-empty input first.
+        TIMESTAMP,   ///< The packet that arrived first, across all inputs.
+    };
+
+    /**
+     * @class IMerger
+     * @brief A node that merges packets from several inputs into one output.
+     *
+     * Every input pad is a lane backed by a wait-free SPSC ring, so producers
+     * on different inputs never contend with each other. Each input accepts
+     * a single upstream link, fed from one thread at a time. A single drain
+     * task on the pipeline's executor takes packets from the lanes in the
+     * order selected by the `MergePolicy` and pushes them to the `"output"`
+     * pad. A producer blocks only when its own lane is full, up to the push
+     * timeout. Packets whose deadline passed while in a lane are dropped.
+     *
+     * The merger needs an executor, so it only starts as part of a `Pipeline`.
+     */
+    class IMerger : public INode, private ITask
+    {
+    public:
+        /**
+         * @brief Destructor.
+         */
+        virtual ~IMerger();
+
+    protected:
+        /**
+         * @brief Constructor. Adds the input pads `"input_1"` to `"input_<inputs>"`
+         *        and the `"output"` pad.
+         * @param inputs The number of inputs.
+         * @param policy The order in which packets are taken from the inputs.
+         * @param laneCapacity The number of packets buffered per input.
+         */
+        IMerger(size_t inputs, MergePolicy policy, size_t laneCapacity);
+
+        /**
+         * @brief Attaches the drain task to the executor.
+         */
+        bool start() noexcept override;
+
+        /**
+         * @brief Waits for the drain task to finish and drops buffered packets.
+         */
+        void stop() noexcept override;
+
+        /**
+         * @brief Packets are taken from the lanes by the drain task, never
+         *        processed directly.
+         */
+        bool processPacket(std::shared_ptr<IPacket> packet, IPad& inputPad, uint32_t timeoutMs) noexcept override;
+
+    private:
+        class LanePad;
+
+        MergePolicy m_policy; ///< The order in which lanes are drained.
+        std::vector<LanePad*> m_lanes; ///< The input lanes.
+        IPad* m_output = nullptr; ///< The output pad.
+        size_t m_next = 0; ///< The next lane to serve in round-robin order.
+        std::atomic_bool m_isRunning{false}; ///< Indicates whether the lanes accept packets.
+        TaskHandoff m_handoff; ///< Keeps one drain task at a time.
+
+        void notifyPacket() noexcept;
+        LanePad* nextLane() noexcept;
+        void run() noexcept override;
+    };
+
+    /**
+     * @class Merger
+     * @brief An `IMerger` with `N` inputs.
+     * @tparam N The number of inputs.
+     */
+    template <size_t N>
+    class Merger : public IMerger
+    {
+        static_assert(N > 0, "Merger requires at least one input");
+
+    public:
+        /**
+         * @brief Constructor.
+         * @param policy The order in which packets are taken from the inputs.
+         * @param laneCapacity The number of packets buffered per input.
+         */
+        explicit Merger(MergePolicy policy = MergePolicy::ROUND_ROBIN, size_t laneCapacity = 64)
+            : IMerger(N, policy, laneCapacity)
+        {
+        }
+
+        /**
+         * @brief Default destructor.
+         */
+        ~Merger() = default;
+    };
+
+    /**
+     * @enum DispatchPolicy
+     * @brief How a dispatcher picks the output for a packet.
+     */
+    enum class DispatchPolicy
+    {
+        ROUND_ROBIN,  ///< The outputs take turns.
+        LEAST_LOADED, ///< The output whose linked pad buffers the fewest packets.
+        KEY_HASH,     ///< The output selected by a key computed from the packet.
+    };
+
+    /**
+     * @class Dispatcher
+     * @brief A node that spreads packets across several outputs, one packet
+     *        per output.
+     *
+     * Unlike a splitter, which broadcasts every packet, a dispatcher sends
+     * each packet to exactly one of its outputs `"output_1"` to
+     * `"output_<outputs>"`. It balances the load over replicas of a stage,
+     * see `Pipeline::addReplicated()`. The replicas run in parallel when
+     * their inputs are queued pads.
+     *
+     * With `DispatchPolicy::LEAST_LOADED` the dispatcher compares the
+     * `IPad::queueDepth()` plus `IPad::inFlight()` of the linked pads, so a
+     * replica busy with a packet is not taken for an idle one; ties go
+     * round-robin. With
+     * `DispatchPolicy::KEY_HASH`, packets with the same key always go to the
+     * same output, which keeps per-key order.
+     */
+    class Dispatcher : public INode
+    {
+    public:
+        /**
+         * @brief Function computing the dispatch key of a packet.
+         */
+        using KeyFunction = std::function<size_t(const IPacket&)>;
+
+        /**
+         * @brief Constructor. Adds the `"input"` pad and the output pads.
+         * @param outputs The number of outputs.
+         * @param policy How the output for a packet is picked.
+         * @param key The key function, required by `DispatchPolicy::KEY_HASH`.
+         */
+        explicit Dispatcher(size_t outputs, DispatchPolicy policy = DispatchPolicy::ROUND_ROBIN, KeyFunction key = nullptr);
+
+        /**
+         * @brief Default destructor.
+         */
+        ~Dispatcher() = default;
+
+        /**
+         * @brief Changes the policy. Must be called before the pipeline starts.
+         * @param policy How the output for a packet is picked.
+         * @param key The key function, required by `DispatchPolicy::KEY_HASH`.
+         */
+        void setPolicy(DispatchPolicy policy, KeyFunction key = nullptr);
+
+        /**
+         * @brief Gets the total headroom of the outputs, since every packet
+         *        goes to one output only.
+         */
+        size_t headroom(size_t hops = 0) const noexcept override;
+
+    protected:
+        /**
+         * @brief Checks the policy.
+         * @return False if the node has no outputs, or the key-hash policy
+         *         has no key function.
+         */
+        bool start() noexcept override;
+
+        /**
+         * @brief Forwards the packet to the output picked by the policy.
+         * @param packet The packet to process.
+         * @param inputPad The input pad that received the packet.
+         * @param timeoutMs The timeout for the operation.
+         * @return True if the packet was successfully pushed, false otherwise.
+         */
+        bool processPacket(std::shared_ptr<IPacket> packet, IPad& inputPad, uint32_t timeoutMs) noexcept override;
+
+    private:
+        DispatchPolicy m_policy; ///< How the output for a packet is picked.
+        KeyFunction m_key; ///< The key function of the key-hash policy.
+        std::atomic<size_t> m_next{0}; ///< Round-robin cursor.
+
+        size_t leastLoaded() noexcept;
+    };
+
+    /**
+     * @enum GapPolicy
+     * @brief What a `Sequencer` does about a missing sequence number.
+     */
+    enum class GapPolicy
+    {
+        SKIP, ///< Give up on the missing packet after the gap timeout or when the window overflows.
+        WAIT, ///< Wait for the missing packet; producers block while the window is full.
+    };
+
+    /**
+     * @class Sequencer
+     * @brief Restores the input order of packets after a parallel section.
+     *
+     * Packets pushed to `"input"` are stamped with consecutive sequence
+     * numbers and forwarded to `"fanout"`, which feeds the parallel section,
+     * for instance a `Dispatcher` and its replicas. The section sends its
+     * results back to `"fanin"`, and the sequencer emits them on `"output"`
+     * in the order of the sequence numbers.
+     *
+     * The stamp belongs to the edge, not to the packet: the pointer sent to
+     * `"fanout"` aliases the packet through a control block of its own, and
+     * the sequencer keeps the number in a table keyed by that control block.
+     * A packet shared with other consumers is therefore never modified, and
+     * no RTTI is needed to find the number again. Stamping costs two
+     * allocations per packet, the control block and the table entry.
+     * Stages forwarding the pointer they received keep the stamp; stages
+     * building a new packet take it over with `carryStamp()`. `"output"`
+     * gets the packet without the stamp. Entries of packets dropped inside
+     * the parallel section are pruned as the table grows.
+     *
+     * Packets arriving ahead of their turn wait in a preallocated reorder
+     * window. Packets are pushed to `"output"` outside the window lock, one
+     * thread at a time, and keep their window slot until they are pushed.
+     * With `GapPolicy::SKIP`, a missing packet is given up once the packets
+     * behind it have waited for the gap timeout, or when a packet falls
+     * beyond the window; it is dropped if it shows up later. Within a
+     * `Pipeline` the timeout is enforced by a task on the executor; a
+     * standalone sequencer checks it when packets arrive, and `flush()`
+     * should be called at the end of a stream. With `GapPolicy::WAIT`,
+     * nothing is skipped and `"fanin"` producers block, up to their push
+     * timeout, while the window is full.
+     */
+    class Sequencer : public INode, private ITask
+    {
+    public:
+        /**
+         * @brief Constructor. Adds the `"input"`, `"fanout"`, `"fanin"` and
+         *        `"output"` pads.
+         * @param window The number of packets the reorder window holds,
+         *        rounded up to a power of two.
+         * @param gapTimeoutMs How long packets wait for a missing one before it
+         *        is skipped, in milliseconds.
+         * @param policy What to do about missing packets.
+         */
+        explicit Sequencer(size_t window = 64, uint32_t gapTimeoutMs = 100, GapPolicy policy = GapPolicy::SKIP);
+
+        /**
+         * @brief Default destructor.
+         */
+        ~Sequencer() = default;
+
+        /**
+         * @brief Emits every packet in the window in order, skipping the gaps.
+         * @param timeoutMs The timeout for pushing the packets.
+         */
+        void flush(uint32_t timeoutMs = 0) noexcept;
+
+        /**
+         * @brief Gets the sequence number of a packet sent to `"fanout"`.
+         * @param packet The packet, as received from `"fanout"`.
+         * @param sequence Receives the sequence number.
+         * @return `false` if the packet carries no stamp of this sequencer.
+         */
+        bool sequenceOf(const std::shared_ptr<IPacket>& packet, uint64_t& sequence) noexcept;
+
+        /**
+         * @brief Stamps a new packet with the sequence number of the packet
+         *        it was built from, so that it takes its place on `"fanin"`.
+         * @param from The packet received from `"fanout"`.
+         * @param to The new packet.
+         * @return The stamped pointer to `to`, or `to` itself if `from`
+         *         carries no stamp of this sequencer.
+         */
+        std::shared_ptr<IPacket> carryStamp(const std::shared_ptr<IPacket>& from, std::shared_ptr<IPacket> to);
+
+    protected:
+        /**
+         * @brief Resets the sequence numbers and the window.
+         */
+        bool start() noexcept override;
+
+        /**
+         * @brief Stops the gap timer, wakes up blocked producers and drops
+         *        the packets in the window.
+         */
+        void stop() noexcept override;
+
+        /**
+         * @brief Stamps packets from `"input"`, reorders packets from `"fanin"`.
+         * @param packet The packet to process.
+         * @param inputPad The input pad that received the packet.
+         * @param timeoutMs The timeout for the operation.
+         * @return False if the packet was dropped or could not be pushed.
+         */
+        bool processPacket(std::shared_ptr<IPacket> packet, IPad& inputPad, uint32_t timeoutMs) noexcept override;
+
+    private:
+        /**
+         * @brief Sequence number of a stamped pointer.
+         */
+        struct Stamp
+        {
+            uint64_t sequence; ///< The sequence number.
+            std::weak_ptr<IPacket> packet; ///< The unstamped packet, kept alive by the stamped pointer.
+        };
+
+        using StampTable = std::map<std::weak_ptr<IPacket>, Stamp, std::owner_less<std::weak_ptr<IPacket>>>;
+
+        GapPolicy m_policy; ///< What to do about missing packets.
+        std::chrono::milliseconds m_gapTimeout; ///< How long a gap may hold packets back.
+        IPad* m_input; ///< Receives the packets to stamp.
+        IPad* m_fanOut; ///< Sends stamped packets to the parallel section.
+        IPad* m_fanIn; ///< Receives packets from the parallel section.
+        IPad* m_output; ///< Sends packets in order.
+        std::atomic<uint64_t> m_stamp{0}; ///< The next sequence number to stamp.
+
+        std::mutex m_stampMutex; ///< Protects the stamp table.
+        StampTable m_stamps; ///< Sequence numbers by control block of the stamped pointers.
+        size_t m_pruneAt; ///< Table size at which entries of dropped packets are pruned.
+
+        std::mutex m_mutex; ///< Protects the window and the ready packets.
+        std::condition_variable m_hasSpace; ///< Signaled when the window moves.
+        std::vector<std::shared_ptr<IPacket>> m_window; ///< Reorder ring indexed by sequence number.
+        std::vector<std::shared_ptr<IPacket>> m_ready; ///< Packets taken from the window, in order, not yet pushed.
+        std::vector<std::shared_ptr<IPacket>> m_sending; ///< Packets being pushed, owned by the emitting thread.
+        uint64_t m_next = 0; ///< The next sequence number to emit.
+        size_t m_buffered = 0; ///< The number of packets in the window.
+        size_t m_unsent = 0; ///< The number of packets taken from the window and not pushed yet.
+        bool m_isEmitting = false; ///< Indicates whether a thread is pushing ready packets.
+        uint32_t m_lastTimeout = 0; ///< Push timeout of the latest `"fanin"` packet, used by the gap timer.
+        std::chrono::steady_clock::time_point m_gapSince; ///< When the oldest waiting packet arrived.
+        bool m_isRunning = false; ///< Indicates whether the window accepts packets.
+        TaskHandoff m_handoff; ///< Keeps one gap timer task at a time.
+
+        std::shared_ptr<IPacket> stamp(uint64_t sequence, std::shared_ptr<IPacket> packet);
+        bool takeStamp(const std::shared_ptr<IPacket>& packet, uint64_t& sequence, std::shared_ptr<IPacket>& original) noexcept;
+        bool reorder(std::shared_ptr<IPacket> packet, uint32_t timeoutMs) noexcept;
+        void collectReady() noexcept;
+        void skipGap() noexcept;
+        bool emit(std::unique_lock<std::mutex>& lock, uint32_t timeoutMs) noexcept;
+        void scheduleGapCheck() noexcept;
+        void run() noexcept override;
+    };
+
+    /**
+     * @struct ChainStageTraits
+     * @brief Deduces the packet types of a `Chain` stage from its call operator.
+     *
+     * A stage is a callable taking `std::shared_ptr<In>` and returning either
+     * `std::shared_ptr<Out>` or `void`.
+     */
+    template <typename Stage>
+    struct ChainStageTraits : ChainStageTraits<decltype(&Stage::operator())> {};
+
+    template <typename C, typename R, typename A>
+    struct ChainStageTraits<R (C::*)(std::shared_ptr<A>)>
+    {
+        using Input = A; ///< The packet type taken by the stage.
+        using Result = R; ///< The return type of the stage.
+    };
+
+    template <typename C, typename R, typename A>
+    struct ChainStageTraits<R (C::*)(std::shared_ptr<A>) const> : ChainStageTraits<R (C::*)(std::shared_ptr<A>)> {};
+
+    template <typename C, typename R, typename A>
+    struct ChainStageTraits<R (C::*)(std::shared_ptr<A>) noexcept> : ChainStageTraits<R (C::*)(std::shared_ptr<A>)> {};
+
+    template <typename C, typename R, typename A>
+    struct ChainStageTraits<R (C::*)(std::shared_ptr<A>) const noexcept> : ChainStageTraits<R (C::*)(std::shared_ptr<A>)> {};
+
+    /**
+     * @class Chain
+     * @brief Fuses a straight chain of typed stages into a single node.
+     *
+     * Each stage is a callable object taking `std::shared_ptr<In>` and
+     * returning `std::shared_ptr<Out>` for the next stage, or `nullptr` to
+     * drop the packet. The stages are stored by value and called directly,
+     * so the compiler can inline the whole chain: a hop costs a function
+     * call instead of a virtual `processPacket`, a pad and a link.
+     *
+     * The node has an `"input"` pad of type `InputPad<In>` for the input type
+     * of the first stage. If the last stage returns a packet, the node also
+     * has an `"output"` pad of type `OutputPad<Out>`; a last stage returning
+     * `void` makes the chain a sink. The packet types of adjacent stages are
+     * checked at compile time.
+     *
+     * @code
+     * struct Parse { std::shared_ptr<Record> operator()(std::shared_ptr<Line> line) const; };
+     * struct Filter { std::shared_ptr<Record> operator()(std::shared_ptr<Record> record) const; };
+     * auto& parser = *pipeline.addNode<Chain<Parse, Filter>>();
+     * @endcode
+     *
+     * @tparam Stages The stage types, in processing order.
+     */
+    template <typename... Stages>
+    class Chain : public INode
+    {
+        static_assert(sizeof...(Stages) > 0, "Chain requires at least one stage");
+
+        static constexpr size_t StageCount = sizeof...(Stages);
+
+        template <size_t I>
+        using Stage = std::tuple_element_t<I, std::tuple<Stages...>>;
+
+        template <size_t I>
+        using StageInput = typename ChainStageTraits<Stage<I>>::Input;
+
+        template <size_t I>
+        using StageResult = typename ChainStageTraits<Stage<I>>::Result;
+
+        template <typename R>
+        struct ResultPacket
+        {
+            using Type = void;
+        };
+
+        template <typename P>
+        struct ResultPacket<std::shared_ptr<P>>
+        {
+            using Type = P;
+        };
+
+        template <size_t... Is>
+        static constexpr bool checkStages(std::index_sequence<Is...>) noexcept
+        {
+            return (std::is_convertible_v<StageResult<Is>, std::shared_ptr<StageInput<Is + 1>>> && ...);
+        }
+
+    public:
+        using Input = StageInput<0>; ///< The packet type accepted by the chain.
+        using Output = typename ResultPacket<StageResult<StageCount - 1>>::Type; ///< The packet type produced, or `void`.
+
+        static_assert(std::is_base_of_v<IPacket, Input>, "Chain stages must take IPacket types");
+        static_assert(std::is_void_v<Output> || std::is_base_of_v<IPacket, Output>,
+                      "The last Chain stage must return an IPacket type or void");
+
+        /**
+         * @brief Constructs the chain with default-constructed stages.
+         */
+        Chain() : Chain(Stages()...) {}
+
+        /**
+         * @brief Constructs the chain from stage objects, for instance lambdas.
+         * @param stages The stages, in processing order.
+         */
+        explicit Chain(Stages... stages) : INode(), m_stages(std::move(stages)...)
+        {
+            static_assert(checkStages(std::make_index_sequence<StageCount - 1>()),
+                          "Each Chain stage must return a packet accepted by the next stage");
+            addInput<InputPad<Input>>("input");
+            if constexpr (!std::is_void_v<Output>)
+            {
+                m_output = &addOutput<OutputPad<Output>>("output");
+            }
+        }
+
+        /**
+         * @brief Default destructor.
+         */
+        ~Chain() = default;
+
+        /**
+         * @brief Returns the stage at index `I`.
+         */
+        template <size_t I>
+        Stage<I>& stage() noexcept { return std::get<I>(m_stages); }
+
+    protected:
+        /**
+         * @brief Runs the packet through all stages.
+         * @param packet The packet to process.
+         * @param inputPad The input pad that received the packet.
+         * @param timeoutMs The timeout for pushing the result to the output.
+         * @return False if the packet has the wrong type or the result could
+         *         not be pushed, true otherwise.
+         */
+        bool processPacket(std::shared_ptr<IPacket> packet, IPad& inputPad, uint32_t timeoutMs) noexcept override final
+        {
+            if (inputPad.packetKey() == packetTypeKey<Input>())
+            {
+                // The typed input pad only lets `Input` packets through
+                return runStage<0>(std::static_pointer_cast<Input>(std::move(packet)), timeoutMs);
+            }
+            auto typedPacket = packet_cast<Input>(std::move(packet));
+            if (!typedPacket)
+            {
+                return false; // Packet type mismatch
+            }
+            return runStage<0>(std::move(typedPacket), timeoutMs);
+        }
+
+    private:
+        using OutputPadType = std::conditional_t<std::is_void_v<Output>, IPad, OutputPad<std::conditional_t<std::is_void_v<Output>, IPacket, Output>>>;
+
+        std::tuple<Stages...> m_stages; ///< The fused stages.
+        OutputPadType* m_output = nullptr; ///< The output pad, unless the chain is a sink.
+
+        template <size_t I, typename P>
+        bool runStage(std::shared_ptr<P> packet, uint32_t timeoutMs) noexcept
+        {
+            if constexpr (I == StageCount)
+            {
+                return m_output->pushPacket(std::move(packet), timeoutMs);
+            }
+            else if constexpr (std::is_void_v<StageResult<I>>)
+            {
+                static_assert(I + 1 == StageCount, "Only the last Chain stage may return void");
+                std::get<I>(m_stages)(std::move(packet));
+                return true;
+            }
+            else
+            {
+                auto next = std::get<I>(m_stages)(std::move(packet));
+                if (!next)
+                {
+                    return true; // Dropped by the stage
+                }
+                return runStage<I + 1>(std::move(next), timeoutMs);
+            }
+        }
+    };
+
 } // namespace lexus2k::pipeline
 
 #endif // LEXUS2K_PIPELINE_NODES_H
\ No newline at end of file
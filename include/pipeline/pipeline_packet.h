@@ -1,8 +1,31 @@
 #ifndef PIPELINE_PACKET_H
 #define PIPELINE_PACKET_H
 
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <type_traits>
+#include <utility>
+
 namespace lexus2k::pipeline
 {
+#if defined(__cpp_rtti) || defined(__GXX_RTTI) || defined(_CPPRTTI)
+#define PIPELINE_HAS_RTTI 1
+#endif
+
+    /**
+     * @struct PacketType
+     * @brief Compile-time identity of a packet type.
+     *
+     * Each `Packet<Derived, Base>` owns one static `PacketType`, linked to
+     * the `PacketType` of its base packet type, if any.
+     */
+    struct PacketType
+    {
+        const PacketType* base; ///< Type of the base packet, or `nullptr`.
+    };
+
     /**
      * @class IPacket
      * @brief Represents a generic data packet in the pipeline.
@@ -13,6 +36,24 @@ namespace lexus2k::pipeline
      */
     class IPacket {
     public:
+        using Clock = std::chrono::steady_clock; ///< The clock deadlines refer to.
+
+        IPacket() noexcept = default;
+
+        /**
+         * @brief Copies a packet. The type tag is set by the most derived
+         *        `Packet<>` of the new object, not copied. The deadline
+         *        is copied, so a packet derived from a copy keeps its budget.
+         */
+        IPacket(const IPacket& other) noexcept
+            : m_deadline(other.m_deadline) {}
+
+        IPacket& operator=(const IPacket& other) noexcept
+        {
+            m_deadline = other.m_deadline;
+            return *this;
+        }
+
         /**
          * @brief Virtual destructor.
          *
@@ -24,8 +65,217 @@ namespace lexus2k::pipeline
         virtual size_t serializeTo(void *ptr, size_t max_size) noexcept { return -1; }
 
         virtual size_t deserializeFrom(const void *ptr, size_t size) noexcept { return -1; }
+
+        /**
+         * @brief Gets the type tag of the packet.
+         * @return The tag of the most derived `Packet<>`, or `nullptr` for
+         *         packets not derived from `Packet<>`.
+         */
+        const PacketType* packetType() const noexcept { return m_packetType; }
+
+        /**
+         * @brief Type tag of `IPacket` itself: packets derived from it directly
+         *        have no base packet type.
+         */
+        static constexpr const PacketType* staticPacketType() noexcept { return nullptr; }
+
+        /**
+         * @brief Gets the point in time after which the packet is stale.
+         * @return The deadline, `Clock::time_point::max()` if there is none.
+         */
+        Clock::time_point deadline() const noexcept { return m_deadline; }
+
+        /**
+         * @brief Tells whether the packet carries a deadline.
+         */
+        bool hasDeadline() const noexcept { return m_deadline != Clock::time_point::max(); }
+
+        /**
+         * @brief Sets the point in time after which the packet is stale.
+         *
+         * Unlike the timeout passed along with a packet, which each hop
+         * applies anew, the deadline covers the whole way through the
+         * pipeline. Queued pads drop packets whose deadline has passed
+         * instead of handing them to their node.
+         *
+         * @param deadline The deadline, `Clock::time_point::max()` for none.
+         */
+        void setDeadline(Clock::time_point deadline) noexcept { m_deadline = deadline; }
+
+        /**
+         * @brief Sets the deadline relative to now.
+         * @param budget The time the packet stays fresh.
+         */
+        template <typename Rep, typename Period>
+        void setDeadline(std::chrono::duration<Rep, Period> budget) noexcept
+        {
+            m_deadline = Clock::now() + std::chrono::duration_cast<Clock::duration>(budget);
+        }
+
+        /**
+         * @brief Tells whether the deadline of the packet has passed.
+         * @param now The current time, read once by callers checking many packets.
+         */
+        bool isExpired(Clock::time_point now = Clock::now()) const noexcept { return now >= m_deadline; }
+
+    private:
+        const PacketType* m_packetType = nullptr; ///< Type tag of the packet.
+        Clock::time_point m_deadline = Clock::time_point::max(); ///< End of the staleness budget.
+
+        template <typename Derived, typename Base>
+        friend class Packet;
+    };
+
+    /**
+     * @class Packet
+     * @brief Base class giving a packet type a compile-time type tag.
+     *
+     * Deriving `class MyPacket : public Packet<MyPacket>` stores a tag in the
+     * packet, so that `packet_cast<MyPacket>` and the typed nodes check the
+     * type with a pointer compare instead of `dynamic_cast`, and also work
+     * without RTTI. Packet hierarchies chain the tags:
+     * `class Special : public Packet<Special, MyPacket>`.
+     *
+     * @tparam Derived The packet type being defined.
+     * @tparam Base The packet base class, `IPacket` by default.
+     */
+    template <typename Derived, typename Base = IPacket>
+    class Packet : public Base
+    {
+        static_assert(std::is_base_of_v<IPacket, Base>, "Packet base must be an IPacket");
+
+    public:
+        using PacketSelf = Derived; ///< The type the tag identifies.
+
+        Packet() noexcept(std::is_nothrow_default_constructible_v<Base>) { this->m_packetType = &s_packetType; }
+
+        Packet(const Packet& other) : Base(other) { this->m_packetType = &s_packetType; }
+
+        /**
+         * @brief Type tag of `Derived`.
+         */
+        static constexpr const PacketType* staticPacketType() noexcept { return &s_packetType; }
+
+    private:
+        static constexpr PacketType s_packetType{Base::staticPacketType()}; ///< Tag of `Derived`.
     };
 
+    /**
+     * @brief Tells whether a type defines its own tag through `Packet<T>`.
+     */
+    template <typename T, typename = void>
+    inline constexpr bool isTaggedPacket = false;
+
+    template <typename T>
+    inline constexpr bool isTaggedPacket<T, std::void_t<typename T::PacketSelf>> =
+        std::is_same_v<typename T::PacketSelf, T>;
+
+    /**
+     * @brief Tells whether a packet is a `T`.
+     *
+     * For types defined with `Packet<T>`, the exact type is found with one
+     * compare and base packet types walk the chain of tags. Other types need
+     * RTTI.
+     */
+    template <typename T>
+    bool isPacketOf(const IPacket& packet) noexcept
+    {
+        if constexpr (std::is_same_v<T, IPacket>)
+        {
+            return true;
+        }
+        else if constexpr (isTaggedPacket<T>)
+        {
+            for (auto* type = packet.packetType(); type != nullptr; type = type->base)
+            {
+                if (type == T::staticPacketType())
+                {
+                    return true;
+                }
+            }
+#ifdef PIPELINE_HAS_RTTI
+            if (packet.packetType() == nullptr)
+            {
+                return dynamic_cast<const T*>(&packet) != nullptr;
+            }
+#endif
+            return false;
+        }
+        else
+        {
+#ifdef PIPELINE_HAS_RTTI
+            return dynamic_cast<const T*>(&packet) != nullptr;
+#else
+            static_assert(isTaggedPacket<T>, "Without RTTI, packet types must derive from Packet<T>");
+            return false;
+#endif
+        }
+    }
+
+    /**
+     * @brief Returns a key unique to the type `T`, for any type.
+     *
+     * Typed pads are marked with the key of their packet type.
+     */
+    template <typename T>
+    const void* packetTypeKey() noexcept
+    {
+        static const char key = 0;
+        return &key;
+    }
+
+    /**
+     * @brief Casts a packet to a derived packet type.
+     *
+     * Types defined with `Packet<T>` are checked through their type tag and
+     * cast with `std::static_pointer_cast`. Other types need RTTI and use
+     * `std::dynamic_pointer_cast`.
+     *
+     * @param packet The packet to cast. It is left untouched if the cast fails.
+     * @return The packet as a `T`, or `nullptr` if it is not a `T`.
+     */
+    template <typename T, typename U>
+    std::shared_ptr<T> packet_cast(std::shared_ptr<U>&& packet) noexcept
+    {
+        if constexpr (std::is_base_of_v<T, U>)
+        {
+            return std::static_pointer_cast<T>(std::move(packet));
+        }
+        else if constexpr (isTaggedPacket<T>)
+        {
+            if (packet && packet->packetType() != nullptr && isPacketOf<T>(*packet))
+            {
+                return std::static_pointer_cast<T>(std::move(packet));
+            }
+#ifdef PIPELINE_HAS_RTTI
+            // Tags are not inherited by classes that do not derive from Packet<>
+            if (packet && packet->packetType() == nullptr)
+            {
+                return std::dynamic_pointer_cast<T>(std::move(packet));
+            }
+#endif
+            return nullptr;
+        }
+        else
+        {
+#ifdef PIPELINE_HAS_RTTI
+            return std::dynamic_pointer_cast<T>(std::move(packet));
+#else
+            static_assert(isTaggedPacket<T>, "Without RTTI, packet types must derive from Packet<T>");
+            return nullptr;
+#endif
+        }
+    }
+
+    /**
+     * @brief Casts a packet to a derived packet type, sharing ownership.
+     */
+    template <typename T, typename U>
+    std::shared_ptr<T> packet_cast(const std::shared_ptr<U>& packet) noexcept
+    {
+        return packet_cast<T>(std::shared_ptr<U>(packet));
+    }
+
 } // namespace lexus2k::pipeline
 
-#endif // PIPELINE_PACKET_H
\ No newline at end of file
+#endif // PIPELINE_PACKET_H
@@ -0,0 +1,273 @@
+#ifndef LEXUS2K_PIPELINE_PACKET_POOL_H
+#define LEXUS2K_PIPELINE_PACKET_POOL_H
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+#include "pipeline_packet.h"
+
+namespace lexus2k::pipeline
+{
+    /**
+     * @class PacketPool
+     * @brief Recycles the memory of packets of type `T`.
+     *
+     * `make()` creates a packet like `std::make_shared<T>()`, but the memory
+     * block holding the packet and its control block comes from a free list.
+     * When the last reference drops, the block goes back to the free list of
+     * the releasing thread instead of the heap. Pooled packets travel
+     * through pads and nodes like any other `std::shared_ptr<IPacket>`, so
+     * the hot path allocates neither a packet nor a control block once the
+     * pool is warm.
+     *
+     * Each thread keeps up to `LocalCapacity` free blocks without locking.
+     * Beyond that, blocks overflow in batches to a global list shared by all
+     * threads, which in turn keeps at most `GlobalCapacity` blocks. A thread
+     * that runs dry refills from the global list before falling back to the
+     * heap, so blocks released by a consumer thread flow back to producers.
+     *
+     * There is one pool per packet type. All members are static.
+     *
+     * @tparam T The packet type. Must be derived from `IPacket`.
+     */
+    template <typename T>
+    class PacketPool
+    {
+        static_assert(std::is_base_of_v<IPacket, T>, "PacketPool requires an IPacket");
+
+    public:
+        static constexpr size_t LocalCapacity = 64; ///< Free blocks kept per thread.
+        static constexpr size_t GlobalCapacity = 4096; ///< Free blocks kept in the global list.
+
+        /**
+         * @struct Stats
+         * @brief Allocation counters of the pool.
+         */
+        struct Stats
+        {
+            uint64_t hits; ///< Allocations served from a free list.
+            uint64_t misses; ///< Allocations that went to the heap.
+            size_t live; ///< Blocks currently in use.
+            size_t highWater; ///< Largest number of blocks in use at once.
+        };
+
+        PacketPool() = delete;
+
+        /**
+         * @brief Creates a pooled packet owned by a `std::shared_ptr`.
+         * @param args The arguments forwarded to the constructor of `T`.
+         */
+        template <typename... Args>
+        static std::shared_ptr<T> make(Args&&... args)
+        {
+            return std::allocate_shared<T>(Allocator<T>(), std::forward<Args>(args)...);
+        }
+
+        /**
+         * @brief Returns the allocation counters of the pool.
+         */
+        static Stats stats() noexcept
+        {
+            return Stats{
+                s_hits.load(std::memory_order_relaxed),
+                s_misses.load(std::memory_order_relaxed),
+                s_live.load(std::memory_order_relaxed),
+                s_highWater.load(std::memory_order_relaxed),
+            };
+        }
+
+        /**
+         * @brief Resets the hit, miss and high-water counters.
+         */
+        static void resetStats() noexcept
+        {
+            s_hits.store(0, std::memory_order_relaxed);
+            s_misses.store(0, std::memory_order_relaxed);
+            s_highWater.store(s_live.load(std::memory_order_relaxed), std::memory_order_relaxed);
+        }
+
+    private:
+        /**
+         * @brief Free lists of blocks of one size.
+         */
+        template <size_t Size, size_t Align>
+        class FreeList
+        {
+        public:
+            static void* acquire()
+            {
+                Cache& cache = localCache();
+                if (cache.head == nullptr)
+                {
+                    refill(cache);
+                }
+                if (Block* block = cache.head)
+                {
+                    cache.head = block->next;
+                    cache.count--;
+                    s_hits.fetch_add(1, std::memory_order_relaxed);
+                    onAcquire();
+                    return block;
+                }
+                void* block = ::operator new(Size, std::align_val_t(Align));
+                s_misses.fetch_add(1, std::memory_order_relaxed);
+                onAcquire();
+                return block;
+            }
+
+            static void release(void* ptr) noexcept
+            {
+                s_live.fetch_sub(1, std::memory_order_relaxed);
+                Cache& cache = localCache();
+                auto* block = static_cast<Block*>(ptr);
+                block->next = cache.head;
+                cache.head = block;
+                if (++cache.count > LocalCapacity)
+                {
+                    spill(cache, LocalCapacity / 2);
+                }
+            }
+
+        private:
+            struct Block
+            {
+                Block* next; ///< Next free block.
+            };
+
+            static_assert(Size >= sizeof(Block), "Pool blocks must hold a free list link");
+
+            struct Global
+            {
+                std::mutex mutex; ///< Protects the global list.
+                Block* head = nullptr; ///< Free blocks shared by all threads.
+                size_t count = 0; ///< Number of blocks in the global list.
+            };
+
+            struct Cache
+            {
+                Block* head = nullptr; ///< Free blocks of the thread.
+                size_t count = 0; ///< Number of blocks in the thread list.
+
+                ~Cache() { spill(*this, count); }
+            };
+
+            static Global& global() noexcept
+            {
+                // Never destroyed: blocks may come back during static destruction
+                static Global* instance = new Global();
+                return *instance;
+            }
+
+            static Cache& localCache() noexcept
+            {
+                thread_local Cache cache;
+                return cache;
+            }
+
+            static void refill(Cache& cache) noexcept
+            {
+                Global& pool = global();
+                std::lock_guard<std::mutex> lock(pool.mutex);
+                for (size_t i = 0; i < LocalCapacity / 2 && pool.head != nullptr; i++)
+                {
+                    Block* block = pool.head;
+                    pool.head = block->next;
+                    pool.count--;
+                    block->next = cache.head;
+                    cache.head = block;
+                    cache.count++;
+                }
+            }
+
+            static void spill(Cache& cache, size_t count) noexcept
+            {
+                Global& pool = global();
+                std::lock_guard<std::mutex> lock(pool.mutex);
+                for (size_t i = 0; i < count && cache.head != nullptr; i++)
+                {
+                    Block* block = cache.head;
+                    cache.head = block->next;
+                    cache.count--;
+                    if (pool.count < GlobalCapacity)
+                    {
+                        block->next = pool.head;
+                        pool.head = block;
+                        pool.count++;
+                    }
+                    else
+                    {
+                        ::operator delete(block, std::align_val_t(Align));
+                    }
+                }
+            }
+
+            static void onAcquire() noexcept
+            {
+                size_t live = s_live.fetch_add(1, std::memory_order_relaxed) + 1;
+                size_t highWater = s_highWater.load(std::memory_order_relaxed);
+                while (live > highWater &&
+                       !s_highWater.compare_exchange_weak(highWater, live, std::memory_order_relaxed))
+                {
+                }
+            }
+        };
+
+        /**
+         * @brief Allocator handing single objects out of the pool.
+         */
+        template <typename U>
+        class Allocator
+        {
+        public:
+            using value_type = U;
+
+            template <typename V>
+            struct rebind
+            {
+                using other = Allocator<V>;
+            };
+
+            Allocator() noexcept = default;
+
+            template <typename V>
+            Allocator(const Allocator<V>&) noexcept {}
+
+            U* allocate(size_t n)
+            {
+                if (n != 1)
+                {
+                    return std::allocator<U>().allocate(n);
+                }
+                return static_cast<U*>(FreeList<sizeof(U), alignof(U)>::acquire());
+            }
+
+            void deallocate(U* ptr, size_t n) noexcept
+            {
+                if (n != 1)
+                {
+                    std::allocator<U>().deallocate(ptr, n);
+                    return;
+                }
+                FreeList<sizeof(U), alignof(U)>::release(ptr);
+            }
+
+            template <typename V>
+            bool operator==(const Allocator<V>&) const noexcept { return true; }
+        };
+
+        static inline std::atomic<uint64_t> s_hits{0}; ///< Allocations served from a free list.
+        static inline std::atomic<uint64_t> s_misses{0}; ///< Allocations that went to the heap.
+        static inline std::atomic<size_t> s_live{0}; ///< Blocks currently in use.
+        static inline std::atomic<size_t> s_highWater{0}; ///< Largest number of blocks in use.
+    };
+
+} // namespace lexus2k::pipeline
+
+#endif // LEXUS2K_PIPELINE_PACKET_POOL_H
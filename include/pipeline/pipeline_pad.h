@@ -1,7 +1,9 @@
 #ifndef LEXUS2K_PIPELINE_PAD_H
 #define LEXUS2K_PIPELINE_PAD_H
 
+#include <atomic>
 #include <memory>
+#include <span>
 #include <vector>
 #include <cstdint>
 #include <mutex>
@@ -37,6 +39,12 @@ namespace lexus2k::pipeline
      * Pads are responsible for transferring packets between nodes and managing
      * their connections. Derived classes can implement specific behaviors for
      * queuing and processing packets.
+     *
+     * The link and the pad type are read without locking on every hop, so
+     * forwarding a packet costs one pointer load per pad. `then()` can relink
+     * a pad while packets flow: a packet already past the load is delivered
+     * to the previous target. Pads are owned by their nodes, which outlive
+     * the links between them, so a replaced target never needs reclaiming.
      */
     class IPad {
     public:
@@ -68,12 +76,30 @@ namespace lexus2k::pipeline
          * Attempts to push a packet to the pad. The behavior depends on the
          * implementation of the `specific` pad method in derived classes.
          *
+         * The packet is moved from hop to hop. Pass it with `std::move` to hand
+         * over ownership, so that crossing a chain of pads and nodes does not
+         * touch its reference count.
+         *
          * @param packet The packet to push.
          * @param timeout The timeout for the operation, in milliseconds.
          * @return `true` if the packet was successfully pushed, `false` otherwise.
          */
         bool pushPacket(std::shared_ptr<IPacket> packet, uint32_t timeout) noexcept;
 
+        /**
+         * @brief Pushes a batch of packets to the pad as one unit.
+         *
+         * Queued input pads take the whole batch under one lock, or one ring
+         * publication per packet, and wake their consumer once. Output pads
+         * forward the batch to the pad they route to.
+         *
+         * @param packets The packets to push, oldest first. They are moved from;
+         *        see `queueBatch` for the packets left on failure.
+         * @param timeout The timeout for the operation, in milliseconds.
+         * @return `true` if all packets were pushed, `false` otherwise.
+         */
+        bool pushBatch(std::span<std::shared_ptr<IPacket>> packets, uint32_t timeout) noexcept;
+
         /**
          * @brief Gets the parent node of the pad.
          * @return A pointer to the parent node.
@@ -84,13 +110,98 @@ namespace lexus2k::pipeline
          * @brief Gets the type of the pad.
          * @return The type of the pad (`INPUT`, `OUTPUT`, or `UNDEFINED`).
          */
-        inline PadType getType() const noexcept { return m_padType; }
+        inline PadType getType() const noexcept { return m_padType.load(std::memory_order_relaxed); }
 
         /**
          * 
          */
         inline size_t getIndex() const noexcept { return m_padIndex; }
 
+        /**
+         * @brief Gets the packet type every packet entering the pad is known to have.
+         * @return The `packetTypeKey` of the type, or `nullptr` for untyped pads.
+         */
+        inline const void* packetKey() const noexcept { return m_packetKey; }
+
+        /**
+         * @brief Tells whether the output pad buffers pushed packets itself.
+         *
+         * Such pads handle packets in `queuePacket` instead of forwarding
+         * them right away, so routes of upstream pads end at them.
+         */
+        inline bool isBuffering() const noexcept { return m_isBuffering; }
+
+        /**
+         * @brief Gets the pad this pad forwards packets to.
+         * @return A pointer to the connected pad, or `nullptr` if not connected.
+         */
+        IPad* linkedPad() const noexcept;
+
+        /**
+         * @brief Tells whether several upstream pads may be linked to this pad.
+         *
+         * Pads built on single-producer queues override this method to return
+         * `false`. `Pipeline::start()` refuses to start a graph where such a pad
+         * has more than one upstream link.
+         *
+         * @return `true` if the pad accepts packets from several producers.
+         */
+        virtual bool acceptsMultipleProducers() const noexcept { return true; }
+
+        /**
+         * @brief Gets the number of packets buffered in the pad.
+         *
+         * Queued pads override this method. The value is a snapshot and may
+         * be out of date by the time it is used.
+         *
+         * @return The number of buffered packets, `0` for pads without a buffer.
+         */
+        virtual size_t queueDepth() const noexcept { return 0; }
+
+        /**
+         * @brief Gets the number of packets taken out of the buffer and being
+         *        processed by the node right now.
+         *
+         * Queued pads override this method. Like `queueDepth`, the value is a
+         * snapshot.
+         *
+         * @return The number of packets in processing, `0` for pads without a buffer.
+         */
+        virtual size_t inFlight() const noexcept { return 0; }
+
+        /**
+         * @brief Gets the number of packets dropped because their deadline passed.
+         */
+        uint64_t expiredPackets() const noexcept { return m_expired.load(std::memory_order_relaxed); }
+
+        /**
+         * @brief Gets the number of packets the pad can buffer.
+         * @return The capacity of the buffer, `0` for pads that process
+         *         packets synchronously.
+         */
+        virtual size_t queueCapacity() const noexcept { return 0; }
+
+        /**
+         * @brief Gets the number of packets the pad would accept right now
+         *        without blocking.
+         *
+         * A queued pad reports its free space. A synchronous input pad
+         * processes packets on the caller's thread, so it reports the
+         * headroom of its node, see `INode::headroom()`. An output pad
+         * reports the headroom of the pad it routes to, or `0` if it is not
+         * connected.
+         *
+         * The value is computed by walking the pads on every call and is a
+         * snapshot: nothing is reserved, so concurrent producers may all see
+         * the same space and some of them still block or fail.
+         *
+         * @param hops The number of pads and nodes already walked by the
+         *        query. Past a fixed depth, for instance around a cycle of
+         *        synchronous pads, the headroom is reported as unbounded.
+         * @return The number of packets, `SIZE_MAX` if there is no limit.
+         */
+        size_t headroom(size_t hops = 0) const noexcept;
+
         /**
          * @brief Connects this pad to another pad.
          *
@@ -98,6 +209,14 @@ namespace lexus2k::pipeline
          * The connection is unidirectional, meaning packets sent from this pad
          * will be forwarded to the connected pad.
          *
+         * Links may be changed while the pipeline runs. When the target is
+         * itself an output pad, packets take the route that pad has at the
+         * time of the call. Such indirect routes are stamped with the link
+         * generation of the pipeline, which every change of a link in it
+         * bumps, so relinking any pad further down invalidates them: the pad
+         * then resolves its route again on its next push. Relinks in other
+         * pipelines leave the route alone.
+         *
          * @param pad The pad to connect to.
          * @return A reference to the parent node of the connected pad.
          */
@@ -152,12 +271,97 @@ namespace lexus2k::pipeline
          */
         bool processPacket(std::shared_ptr<IPacket> packet, uint32_t timeout) noexcept;
 
+        /**
+         * @brief Processes a batch of packets.
+         *
+         * Hands a batch of packets over to the parent node in one call.
+         *
+         * @param packets The packets to process, oldest first.
+         * @param timeout The timeout for the operation, in milliseconds.
+         * @return `true` if all packets were successfully processed, `false` otherwise.
+         */
+        bool processBatch(std::span<std::shared_ptr<IPacket>> packets, uint32_t timeout) noexcept;
+
+        /**
+         * @brief Queues a packet whose type was proven at compile time.
+         *
+         * Typed output pads call this method on the input pad they were
+         * connected to with a typed connection. Typed input pads override it
+         * to skip the type check done in `queuePacket`.
+         *
+         * @param packet The packet to queue.
+         * @param timeout The timeout for the operation, in milliseconds.
+         * @return `true` if the packet was successfully queued, `false` otherwise.
+         */
+        virtual bool queueCheckedPacket(std::shared_ptr<IPacket> packet, uint32_t timeout) noexcept
+        {
+            return queuePacket(std::move(packet), timeout);
+        }
+
+        /**
+         * @brief Queues a batch of packets for processing.
+         *
+         * The default implementation queues the packets one by one. Queued
+         * pads override it to amortize locking and wake-ups over the batch.
+         *
+         * When the pad gives up, the packets it did not take are left in the
+         * span, so the caller can tell how many were lost. The default
+         * implementation hands every packet to `queuePacket` and leaves none.
+         *
+         * @param packets The packets to queue, oldest first. They are moved from.
+         * @param timeout The timeout for the operation, in milliseconds.
+         * @return `true` if all packets were queued, `false` otherwise.
+         */
+        virtual bool queueBatch(std::span<std::shared_ptr<IPacket>> packets, uint32_t timeout) noexcept;
+
+        /**
+         * @brief Sends a batch of packets to the pad this output pad routes to.
+         * @param packets The packets to send, oldest first. They are moved from.
+         * @param timeout The timeout for the operation, in milliseconds.
+         * @return `true` if all packets were delivered, `false` otherwise.
+         */
+        bool forwardBatch(std::span<std::shared_ptr<IPacket>> packets, uint32_t timeout) noexcept;
+
+        /**
+         * @brief Drops a packet whose deadline has already passed.
+         *
+         * Input pads call it before processing or buffering a packet.
+         *
+         * @param packet The packet about to be taken.
+         * @return `true` if the packet is stale and was dropped.
+         */
+        bool dropExpired(const std::shared_ptr<IPacket>& packet) noexcept;
+
+        /**
+         * @brief Counts stale packets a derived pad dropped by itself.
+         * @param count The number of packets.
+         */
+        void countExpired(size_t count) noexcept { m_expired.fetch_add(count, std::memory_order_relaxed); }
+
+        /**
+         * @brief Marks an output pad that buffers pushed packets itself.
+         *
+         * Must be called from the constructor of the derived pad.
+         */
+        inline void setBuffering() noexcept { m_isBuffering = true; }
+
+        /**
+         * @brief Marks the pad with the packet type of all entering packets.
+         * @param key The `packetTypeKey` of the type.
+         */
+        inline void setPacketKey(const void* key) noexcept { m_packetKey = key; }
+
     private:
-        std::mutex m_mutex; ///< Mutex for thread safety.
+        std::mutex m_mutex; ///< Serializes changes of the link.
         INode* m_parentNode = nullptr; ///< Pointer to the parent node of the pad.
-        IPad* m_linkedPad = nullptr;   ///< Pointer to the connected pad.
-        PadType m_padType = PadType::INPUT; ///< The type of the pad.
+        std::atomic<IPad*> m_linkedPad{nullptr}; ///< Pointer to the connected pad.
+        std::atomic<IPad*> m_route{nullptr}; ///< The input pad packets end up in, through chained output pads.
+        std::atomic<uint64_t> m_routeGeneration{0}; ///< Link generation the route was resolved at, `0` for the linked pad itself.
+        std::atomic<PadType> m_padType{PadType::INPUT}; ///< The type of the pad.
         size_t m_padIndex = 0; ///< The index of the pad in the parent node.
+        const void* m_packetKey = nullptr; ///< Packet type of typed input pads.
+        bool m_isBuffering = false; ///< Set for output pads that handle pushed packets in queuePacket().
+        std::atomic<uint64_t> m_expired{0}; ///< Packets dropped because their deadline passed.
 
         /**
          * @brief Sets the parent node of the pad.
@@ -175,9 +379,67 @@ namespace lexus2k::pipeline
          * @brief Sets the type of the pad.
          * @param type The type to set (`INPUT`, `OUTPUT`, or `UNDEFINED`).
          */
-        inline void setType(PadType type) noexcept { m_padType = type; }
+        inline void setType(PadType type) noexcept { m_padType.store(type, std::memory_order_relaxed); }
+
+        /**
+         * @brief Gets the counter of link changes this pad's routes are checked against.
+         *
+         * Pads of nodes in a `Pipeline` share the counter of the pipeline;
+         * pads of nodes used on their own share a process-wide one.
+         */
+        std::atomic<uint64_t>& linkScope() const noexcept;
+
+        /**
+         * @brief Gets the current link generation of the pad's scope.
+         *
+         * Read it before resolving a route: a link changed after the read
+         * bumps the generation past it.
+         */
+        uint64_t linkGeneration() const noexcept { return linkScope().load(std::memory_order_acquire); }
+
+        /**
+         * @brief Sets the input pad packets pushed to this pad end up in.
+         * @param route The input pad, or `nullptr` to follow the link.
+         * @param generation The link generation read before the route was resolved.
+         */
+        inline void setRoute(IPad* route, uint64_t generation) noexcept
+        {
+            // A route to the linked pad itself stays valid until this pad relinks
+            m_routeGeneration.store(route == m_linkedPad.load(std::memory_order_relaxed) ? 0 : generation,
+                                    std::memory_order_relaxed);
+            m_route.store(route, std::memory_order_release);
+        }
+
+        /**
+         * @brief Gets the route if no link changed since it was resolved.
+         * @return The route, or `nullptr` if there is none or it is stale.
+         */
+        IPad* validRoute() const noexcept;
+
+        /**
+         * @brief Gets the route, resolving it again if it is stale.
+         * @return The route, or `nullptr` to follow the link.
+         */
+        IPad* currentRoute() noexcept;
+
+        /**
+         * @brief Follows the link through chained output pads and caches the
+         *        route at the end.
+         *
+         * Routes through output pads of another link scope are not cached,
+         * since their relinks do not bump this pad's generation.
+         *
+         * @param maxHops The number of pads after which the chain must be a loop.
+         * @return The input pad or buffering output pad packets end up in, or
+         *         `nullptr` to follow the link.
+         */
+        IPad* resolveRoute(size_t maxHops) noexcept;
 
         friend class INode;
+        friend class Pipeline;
+
+        template <typename T>
+        friend class OutputPad;
     };
 
 } // namespace lexus2k::pipeline
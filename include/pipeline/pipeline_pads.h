@@ -2,11 +2,18 @@
 #define PIPELINE_PADS_H
 
 #include "pipeline_pad.h"
+#include "pipeline_executor.h"
+#include "pipeline_ring.h"
 #include <atomic>
+#include <chrono>
+#include <deque>
+#include <functional>
 #include <thread>
 #include <vector>
 #include <mutex>
 #include <condition_variable>
+#include <type_traits>
+#include <utility>
 
 namespace lexus2k::pipeline
 {
@@ -41,6 +48,8 @@ namespace lexus2k::pipeline
          *
          * This method overrides the `queuePacket` method in the `IPad` base
          * class. It immediately forwards the packet to the next connected pad.
+         * A packet whose deadline has passed is dropped instead, and the
+         * timeout handed on never exceeds the time the packet has left.
          *
          * @param packet The packet to queue.
          * @param timeout The timeout for the operation, in milliseconds.
@@ -49,16 +58,147 @@ namespace lexus2k::pipeline
         bool queuePacket(std::shared_ptr<IPacket> packet, uint32_t timeout) noexcept override;
     };
 
+    /**
+     * @class IQueuedPad
+     * @brief Base class for pads that buffer packets and process them asynchronously.
+     *
+     * The `IQueuedPad` class owns the scheduling of queued pads. Derived
+     * classes only implement the buffer itself: `queuePacket` stores a packet
+     * and calls `notifyPacket`, and `dequeue` hands buffered packets back.
+     *
+     * When the parent node belongs to a `Pipeline`, the pad runs as a task on
+     * the pipeline's executor: it is scheduled whenever it has packets and
+     * at most one task per pad runs at a time, so the node still sees packets
+     * from this pad one batch after another. Otherwise the pad falls back to a
+     * dedicated thread, which spins briefly when the buffer runs dry and only
+     * sleeps when it stays empty.
+     *
+     * With a batch size greater than one, up to that many packets are drained
+     * at once and handed to `INode::processBatch`.
+     *
+     * Packets carrying a deadline (see `IPacket::setDeadline`) are dropped
+     * when they are already stale on arrival or after waiting in the buffer,
+     * and the timeout handed to the node never exceeds the time they have
+     * left. Dropped packets are counted in `IPad::expiredPackets()`. Packets
+     * without a deadline cost no clock reads.
+     */
+    class IQueuedPad : public IPad, private ITask
+    {
+    public:
+        /**
+         * @brief Default destructor.
+         */
+        ~IQueuedPad() = default;
+
+        /**
+         * @brief Starts processing packets.
+         *
+         * This method overrides the `start` method in the `IPad` base class.
+         * It attaches the pad to the executor of the parent node, or starts a
+         * background thread if the node has none.
+         */
+        bool start() noexcept override;
+
+        /**
+         * @brief Stops processing packets.
+         *
+         * This method overrides the `stop` method in the `IPad` base class.
+         * It waits until the pad is no longer processing. Packets still
+         * buffered are dropped.
+         *
+         * When called from the pad's own processing context, for example by
+         * the node while it handles a packet from this pad, it cannot wait for
+         * itself: it only marks the pad as stopped and drops the buffered
+         * packets, and processing ends once the node returns. A dedicated
+         * thread is then joined by the next `start` or `stop`.
+         */
+        void stop() noexcept override;
+
+        size_t inFlight() const noexcept override { return m_inFlight.load(std::memory_order_relaxed); }
+
+    protected:
+        /**
+         * @brief Constructor.
+         * @param batchSize The maximum number of packets drained at once.
+         */
+        explicit IQueuedPad(size_t batchSize) : IPad(), m_batchSize(batchSize ? batchSize : 1) {}
+
+        /**
+         * @brief Tells whether the pad accepts packets.
+         */
+        bool isRunning() const noexcept { return m_isRunning.load(std::memory_order_acquire); }
+
+        /**
+         * @brief Must be called by derived classes after a packet was buffered.
+         */
+        void notifyPacket() noexcept;
+
+        /**
+         * @brief Gets the time until which a producer may wait for space.
+         * @param packet The packet to buffer.
+         * @param timeout The timeout of the operation, in milliseconds.
+         * @return The end of the timeout, or the deadline of the packet if earlier.
+         */
+        static IPacket::Clock::time_point waitLimit(const std::shared_ptr<IPacket>& packet, uint32_t timeout) noexcept;
+
+        /**
+         * @brief Takes buffered packets without blocking.
+         *
+         * Only called from the processing context, never concurrently.
+         *
+         * @param batch Receives the packets, oldest first.
+         * @param maxCount The maximum number of packets to take.
+         * @param timeout Receives the smallest timeout of the taken packets.
+         * @return The number of packets taken.
+         */
+        virtual size_t dequeue(std::vector<std::shared_ptr<IPacket>>& batch, size_t maxCount, uint32_t& timeout) noexcept = 0;
+
+        /**
+         * @brief Tells whether the buffer is empty.
+         */
+        virtual bool empty() const noexcept = 0;
+
+        /**
+         * @brief Drops all buffered packets.
+         */
+        virtual void clear() noexcept = 0;
+
+        /**
+         * @brief Wakes up producers blocked on a full buffer.
+         *
+         * Called once the pad is no longer running, so that waiting producers
+         * can give up.
+         */
+        virtual void wakeProducers() noexcept {}
+
+    private:
+        size_t m_batchSize = 1; ///< The maximum number of packets drained at once.
+        std::vector<std::shared_ptr<IPacket>> m_batch; ///< Packets being processed.
+        std::atomic<size_t> m_inFlight{0}; ///< Number of packets handed to the node and not done yet.
+        std::atomic_bool m_isRunning{false}; ///< Indicates whether the pad is processing.
+        std::atomic_bool m_isWaiting{false}; ///< Set while the processing thread sleeps.
+        std::atomic<uint32_t> m_wakeups{0}; ///< Wake-up counter the processing thread sleeps on.
+        TaskHandoff m_handoff; ///< Keeps one processing task at a time.
+        std::atomic<IExecutor*> m_executor{nullptr}; ///< The executor the pad runs on, if any.
+        std::atomic<std::thread::id> m_runner{}; ///< The thread currently processing packets.
+        std::thread m_thread; ///< The background thread when there is no executor.
+
+        bool drainBatch() noexcept;
+        void dropExpiredBatch(uint32_t& timeout) noexcept;
+        void threadBody() noexcept;
+        void run() noexcept override;
+    };
+
     /**
      * @class QueuePad
      * @brief A pad that queues packets for processing.
      *
-     * The `QueuePad` class is an implementation of `IPad` that maintains a
+     * The `QueuePad` class is an implementation of `IQueuedPad` that maintains a
      * queue of packets. Packets are processed in the order they are received,
      * and the queue size is configurable. This pad is suitable for scenarios
      * where packets need to be buffered before processing.
      */
-    class QueuePad : public IPad
+    class QueuePad : public IQueuedPad
     {
     public:
         /**
@@ -69,7 +209,7 @@ namespace lexus2k::pipeline
          * @tparam N The maximum size of the queue.
          */
         template <size_t N>
-        QueuePad() : IPad(), m_maxQueueSize(N) {}
+        QueuePad() : IQueuedPad(1), m_maxQueueSize(N) {}
 
         /**
          * @brief Constructor with a runtime-configurable queue size.
@@ -77,8 +217,9 @@ namespace lexus2k::pipeline
          * Initializes the `QueuePad` instance with the specified maximum queue size.
          *
          * @param N The maximum size of the queue. Defaults to `4`.
+         * @param batchSize The maximum number of packets drained at once. Defaults to `1`.
          */
-        QueuePad(size_t N = 4) : IPad(), m_maxQueueSize(N) {}
+        QueuePad(size_t N = 4, size_t batchSize = 1) : IQueuedPad(batchSize), m_maxQueueSize(N) {}
 
         /**
          * @brief Default destructor.
@@ -88,20 +229,14 @@ namespace lexus2k::pipeline
         ~QueuePad() = default;
 
         /**
-         * @brief Starts the queue processing thread.
-         *
-         * This method overrides the `start` method in the `IPad` base class.
-         * It starts a background thread that processes packets from the queue.
+         * @brief Gets the number of packets in the queue.
          */
-        bool start() noexcept override;
+        size_t queueDepth() const noexcept override;
 
         /**
-         * @brief Stops the queue processing thread.
-         *
-         * This method overrides the `stop` method in the `IPad` base class.
-         * It stops the background thread and ensures all resources are cleaned up.
+         * @brief Gets the maximum size of the queue.
          */
-        void stop() noexcept override;
+        size_t queueCapacity() const noexcept override { return m_maxQueueSize; }
 
     protected:
         /**
@@ -109,7 +244,7 @@ namespace lexus2k::pipeline
          *
          * This method overrides the `queuePacket` method in the `IPad` base
          * class. It adds the packet to the queue and notifies the processing
-         * thread.
+         * context.
          *
          * @param packet The packet to queue.
          * @param timeout The timeout for the operation, in milliseconds.
@@ -117,14 +252,569 @@ namespace lexus2k::pipeline
          */
         bool queuePacket(std::shared_ptr<IPacket> packet, uint32_t timeout) noexcept override;
 
+        /**
+         * @brief Queues a batch of packets for processing.
+         *
+         * Takes the lock once for as many packets as fit into the queue and
+         * notifies the processing context once for them. Stale packets are
+         * dropped and reset in the span while the others are still queued.
+         *
+         * @param packets The packets to queue, oldest first.
+         * @param timeout The timeout for the operation, in milliseconds.
+         * @return `true` if all packets were queued, `false` if some were
+         *         dropped or not taken.
+         */
+        bool queueBatch(std::span<std::shared_ptr<IPacket>> packets, uint32_t timeout) noexcept override;
+
+        size_t dequeue(std::vector<std::shared_ptr<IPacket>>& batch, size_t maxCount, uint32_t& timeout) noexcept override;
+
+        bool empty() const noexcept override;
+
+        void clear() noexcept override;
+
+        void wakeProducers() noexcept override;
+
     private:
         size_t m_maxQueueSize; ///< The maximum size of the queue.
-        std::mutex m_mutex; ///< Mutex for synchronizing access to the queue.
-        std::condition_variable m_hasPackets; ///< Condition variable for waiting on packets.
+        mutable std::mutex m_mutex; ///< Mutex for synchronizing access to the queue.
         std::condition_variable m_hasSpace; ///< Condition variable for waiting on available space.
-        std::vector<std::pair<uint32_t, std::shared_ptr<IPacket>>> m_queue; ///< The packet queue.
-        std::atomic_bool m_isRunning{false}; ///< Indicates whether the queue processing thread is running.
-        std::thread m_thread; ///< The background thread for processing packets.
+        std::deque<std::pair<uint32_t, std::shared_ptr<IPacket>>> m_queue; ///< The packet queue.
+    };
+
+    /**
+     * @class BasicRingPad
+     * @brief A queued pad backed by a lock-free bounded ring buffer.
+     *
+     * The `BasicRingPad` class holds the logic shared by the ring-based pads.
+     * Producers enqueue without taking a lock, and packets are dequeued in
+     * constant time.
+     *
+     * @tparam Ring The ring buffer template (`MpscRing` or `SpscRing`).
+     */
+    template <template <typename> class Ring>
+    class BasicRingPad : public IQueuedPad
+    {
+    public:
+        /**
+         * @brief Constructor with a runtime-configurable capacity.
+         *
+         * @param N The capacity of the ring, rounded up to a power of two.
+         * @param batchSize The maximum number of packets drained at once.
+         */
+        BasicRingPad(size_t N, size_t batchSize) : IQueuedPad(batchSize), m_ring(N) {}
+
+        /**
+         * @brief Default destructor.
+         *
+         * Ensures proper cleanup of the `BasicRingPad` instance.
+         */
+        ~BasicRingPad() = default;
+
+        /**
+         * @brief Gets the approximate number of packets in the ring.
+         */
+        size_t queueDepth() const noexcept override { return m_ring.size(); }
+
+        /**
+         * @brief Gets the capacity of the ring.
+         */
+        size_t queueCapacity() const noexcept override { return m_ring.capacity(); }
+
+    protected:
+        /**
+         * @brief Queues a packet for processing.
+         *
+         * If the ring is full, the caller backs off until space becomes
+         * available or the timeout expires.
+         *
+         * @param packet The packet to queue.
+         * @param timeout The timeout for the operation, in milliseconds.
+         * @return `true` if the packet was successfully queued, `false` otherwise.
+         */
+        bool queuePacket(std::shared_ptr<IPacket> packet, uint32_t timeout) noexcept override;
+
+        /**
+         * @brief Queues a batch of packets for processing.
+         *
+         * The consumer is notified once for the batch, or each time the
+         * ring fills up before the batch is complete. Stale packets are
+         * dropped and reset in the span while the others are still queued.
+         *
+         * @param packets The packets to queue, oldest first.
+         * @param timeout The timeout for the operation, in milliseconds.
+         * @return `true` if all packets were queued, `false` if some were
+         *         dropped or not taken.
+         */
+        bool queueBatch(std::span<std::shared_ptr<IPacket>> packets, uint32_t timeout) noexcept override;
+
+        size_t dequeue(std::vector<std::shared_ptr<IPacket>>& batch, size_t maxCount, uint32_t& timeout) noexcept override;
+
+        bool empty() const noexcept override { return m_ring.empty(); }
+
+        void clear() noexcept override;
+
+    private:
+        using Item = std::pair<uint32_t, std::shared_ptr<IPacket>>;
+
+        Ring<Item> m_ring; ///< The packet ring.
+
+        bool waitPush(Item& item, uint32_t timeout) noexcept;
+    };
+
+    extern template class BasicRingPad<MpscRing>;
+    extern template class BasicRingPad<SpscRing>;
+
+    /**
+     * @class RingQueuePad
+     * @brief A queued pad backed by a lock-free bounded MPSC ring buffer.
+     *
+     * The `RingQueuePad` class is a drop-in alternative to `QueuePad` for
+     * inputs fed by many producer threads.
+     */
+    class RingQueuePad : public BasicRingPad<MpscRing>
+    {
+    public:
+        /**
+         * @brief Constructor with a runtime-configurable capacity.
+         *
+         * @param N The capacity of the ring, rounded up to a power of two.
+         *          Defaults to `64`.
+         * @param batchSize The maximum number of packets drained at once. Defaults to `1`.
+         */
+        RingQueuePad(size_t N = 64, size_t batchSize = 1) : BasicRingPad(N, batchSize) {}
+    };
+
+    /**
+     * @class SpscQueuePad
+     * @brief A queued pad backed by a wait-free SPSC ring buffer.
+     *
+     * The `SpscQueuePad` class is meant for point-to-point links, where a
+     * single upstream pad feeds this pad from a single thread. It uses no
+     * mutex and no read-modify-write operations on the packet path.
+     * `Pipeline::start()` fails if more than one pad is linked to it.
+     *
+     * The link check does not cover threads: direct `pushPacket` calls from
+     * several threads, or an upstream pad driven by several threads at once,
+     * corrupt the ring. Debug builds assert when two pushes overlap; release
+     * builds do not check.
+     */
+    class SpscQueuePad : public BasicRingPad<SpscRing>
+    {
+    public:
+        /**
+         * @brief Constructor with a runtime-configurable capacity.
+         *
+         * @param N The capacity of the ring, rounded up to a power of two.
+         *          Defaults to `64`.
+         * @param batchSize The maximum number of packets drained at once. Defaults to `1`.
+         */
+        SpscQueuePad(size_t N = 64, size_t batchSize = 1) : BasicRingPad(N, batchSize) {}
+
+        /**
+         * @brief A single-producer ring accepts only one upstream link.
+         */
+        bool acceptsMultipleProducers() const noexcept override { return false; }
+
+    protected:
+        bool queuePacket(std::shared_ptr<IPacket> packet, uint32_t timeout) noexcept override;
+
+        bool queueBatch(std::span<std::shared_ptr<IPacket>> packets, uint32_t timeout) noexcept override;
+
+    private:
+        std::atomic_bool m_isPushing{false}; ///< Set while a push is in progress, checked in debug builds.
+    };
+
+    /**
+     * @enum LaneScheduling
+     * @brief How a `PriorityQueuePad` shares its consumer between lanes.
+     */
+    enum class LaneScheduling
+    {
+        STRICT,   ///< Always the highest non-empty lane. Lower lanes may starve.
+        WEIGHTED, ///< Up to `weight` packets per lane in turn, highest lane first.
+    };
+
+    /**
+     * @struct PriorityLane
+     * @brief Configuration of one lane of a `PriorityQueuePad`.
+     */
+    struct PriorityLane
+    {
+        size_t capacity = 64; ///< The capacity of the lane, rounded up to a power of two.
+        uint32_t weight = 1; ///< Packets taken from the lane per turn with `WEIGHTED` scheduling.
+    };
+
+    /**
+     * @class PriorityQueuePad
+     * @brief A queued pad with one lock-free lane per priority level.
+     *
+     * Each lane is an MPSC ring with its own capacity, so bulk traffic
+     * filling a low lane never blocks producers of a higher lane. A packet
+     * enters the lane picked by the classifier of the pad, or by the argument
+     * of `pushPacket` when producers push to the pad directly. The priority
+     * belongs to the pad, not to the packet, so a packet shared between
+     * several pads may take a different lane in each. Without a classifier
+     * packets go to the lowest lane. Priorities above the highest lane go to
+     * the highest lane.
+     *
+     * The consumer serves lanes with `STRICT` or `WEIGHTED` scheduling.
+     * Packets keep their order within a lane only.
+     */
+    class PriorityQueuePad : public IQueuedPad
+    {
+    public:
+        /**
+         * @brief Function computing the priority of a packet. Higher values
+         *        are more urgent.
+         */
+        using Classifier = std::function<uint8_t(const IPacket&)>;
+
+        /**
+         * @brief Constructor.
+         * @param lanes The lanes, from the lowest to the highest priority.
+         * @param scheduling How the consumer shares its time between lanes.
+         * @param batchSize The maximum number of packets drained at once. Defaults to `1`.
+         */
+        explicit PriorityQueuePad(std::vector<PriorityLane> lanes,
+                                  LaneScheduling scheduling = LaneScheduling::STRICT,
+                                  size_t batchSize = 1);
+
+        /**
+         * @brief Constructor with lanes of equal capacity.
+         *
+         * With `WEIGHTED` scheduling, lane `i` gets weight `i + 1`.
+         *
+         * @param lanes The number of priority levels. Defaults to `2`.
+         * @param capacity The capacity of each lane. Defaults to `64`.
+         * @param scheduling How the consumer shares its time between lanes.
+         * @param batchSize The maximum number of packets drained at once. Defaults to `1`.
+         */
+        explicit PriorityQueuePad(size_t lanes = 2, size_t capacity = 64,
+                                  LaneScheduling scheduling = LaneScheduling::STRICT,
+                                  size_t batchSize = 1);
+
+        /**
+         * @brief Default destructor.
+         */
+        ~PriorityQueuePad() = default;
+
+        using IPad::pushPacket;
+
+        /**
+         * @brief Sets how packets are assigned to lanes. Must be called
+         *        before the pipeline starts.
+         * @param classifier The function computing the priority of a packet,
+         *        `nullptr` to queue every packet in the lowest lane.
+         */
+        void setClassifier(Classifier classifier);
+
+        /**
+         * @brief Pushes a packet to the lane of the given priority.
+         * @param packet The packet to push.
+         * @param timeout The timeout for the operation, in milliseconds.
+         * @param priority The priority, overriding the classifier.
+         * @return `true` if the packet was successfully queued, `false` otherwise.
+         */
+        bool pushPacket(std::shared_ptr<IPacket> packet, uint32_t timeout, uint8_t priority) noexcept;
+
+        /**
+         * @brief Gets the number of lanes.
+         */
+        size_t laneCount() const noexcept { return m_lanes.size(); }
+
+        /**
+         * @brief Gets the approximate number of packets in one lane.
+         * @param priority The priority of the lane.
+         */
+        size_t laneDepth(uint8_t priority) const noexcept;
+
+        /**
+         * @brief Gets the approximate number of packets in all lanes.
+         */
+        size_t queueDepth() const noexcept override;
+
+        /**
+         * @brief Gets the capacity of all lanes together.
+         */
+        size_t queueCapacity() const noexcept override;
+
+    protected:
+        /**
+         * @brief Queues a packet in the lane picked by the classifier.
+         *
+         * If the lane is full, the caller backs off until space becomes
+         * available or the timeout expires.
+         *
+         * @param packet The packet to queue.
+         * @param timeout The timeout for the operation, in milliseconds.
+         * @return `true` if the packet was successfully queued, `false` otherwise.
+         */
+        bool queuePacket(std::shared_ptr<IPacket> packet, uint32_t timeout) noexcept override;
+
+        size_t dequeue(std::vector<std::shared_ptr<IPacket>>& batch, size_t maxCount, uint32_t& timeout) noexcept override;
+
+        bool empty() const noexcept override;
+
+        void clear() noexcept override;
+
+    private:
+        using Item = std::pair<uint32_t, std::shared_ptr<IPacket>>;
+
+        struct Lane
+        {
+            explicit Lane(const PriorityLane& config) : ring(config.capacity), weight(config.weight ? config.weight : 1) {}
+
+            MpscRing<Item> ring; ///< The packets of the lane.
+            uint32_t weight; ///< Packets taken per turn with weighted scheduling.
+        };
+
+        std::vector<std::unique_ptr<Lane>> m_lanes; ///< The lanes, lowest priority first.
+        Classifier m_classifier; ///< Computes the priority of queued packets.
+        LaneScheduling m_scheduling; ///< How lanes are served.
+        size_t m_current = 0; ///< The lane being served with weighted scheduling.
+        uint32_t m_credit = 0; ///< Packets the current lane may still give this turn.
+
+        bool pushToLane(Lane& lane, std::shared_ptr<IPacket> packet, uint32_t timeout) noexcept;
+    };
+
+    /**
+     * @class BatchingPad
+     * @brief An output pad that delivers packets in batches.
+     *
+     * Packets pushed to the pad are collected until the batch reaches its
+     * target size or the oldest packet has waited for the latency budget.
+     * The batch is then handed to the linked pad with `pushBatch()`, so a
+     * queued pad takes it under one lock and wakes its consumer once. A
+     * consumer with a batch size greater than one receives it through
+     * `INode::processBatch`.
+     *
+     * The target size follows the arrival rate: it is the number of packets
+     * expected within the latency budget, between one and the maximum batch
+     * size. At low load packets therefore leave one by one without delay,
+     * while at peak load batches grow up to the maximum.
+     *
+     * Batches are delivered outside the lock of the pad, so producers keep
+     * adding packets to the next batch meanwhile. Each closed batch takes a
+     * turn, and the thread that closed it waits for the earlier batches to
+     * be delivered first, so batches keep their order when several threads
+     * push to the pad. Packets of a batch the linked pad does not take are
+     * counted by `droppedPackets()` and traced as `TraceEvent::DROP`.
+     *
+     * When the parent node runs on an executor, a flush task scheduled with
+     * `IExecutor::scheduleAt` delivers a batch whose budget expires before it
+     * fills up. Without an executor, such a batch waits for the next packet,
+     * `flush()` or `stop()`.
+     */
+    class BatchingPad : public IPad, private ITask
+    {
+    public:
+        /**
+         * @brief Constructor.
+         * @param maxBatch The maximum number of packets per batch. Defaults to `32`.
+         * @param latencyBudgetUs The longest time a packet waits for its batch,
+         *        in microseconds. Defaults to `100`.
+         */
+        explicit BatchingPad(size_t maxBatch = 32, uint32_t latencyBudgetUs = 100);
+
+        /**
+         * @brief Default destructor.
+         */
+        ~BatchingPad() = default;
+
+        /**
+         * @brief Attaches the pad to the executor of the parent node.
+         */
+        bool start() noexcept override;
+
+        /**
+         * @brief Cancels or waits for the flush task and delivers the pending batch.
+         */
+        void stop() noexcept override;
+
+        /**
+         * @brief Delivers the pending batch now.
+         * @return `true` if the batch was delivered or empty, `false` otherwise.
+         */
+        bool flush() noexcept;
+
+        /**
+         * @brief Gets the current target batch size.
+         */
+        size_t batchTarget() const noexcept { return m_target.load(std::memory_order_relaxed); }
+
+        /**
+         * @brief Gets the maximum number of packets per batch.
+         */
+        size_t maxBatch() const noexcept { return m_maxBatch; }
+
+        /**
+         * @brief Gets the number of packets of delivered batches that the
+         *        linked pad did not take.
+         */
+        uint64_t droppedPackets() const noexcept { return m_dropped.load(std::memory_order_relaxed); }
+
+    protected:
+        /**
+         * @brief Adds a packet to the pending batch.
+         *
+         * Delivers the batch if it reached its target size or its budget.
+         *
+         * @param packet The packet to add.
+         * @param timeout The timeout for the delivery, in milliseconds.
+         * @return `true` if the packet was buffered or delivered, `false` otherwise.
+         */
+        bool queuePacket(std::shared_ptr<IPacket> packet, uint32_t timeout) noexcept override;
+
+    private:
+        using Clock = std::chrono::steady_clock;
+
+        size_t m_maxBatch; ///< The maximum number of packets per batch.
+        std::chrono::nanoseconds m_budget; ///< The longest time a packet waits for its batch.
+        std::mutex m_mutex; ///< Protects the pending batch, the turns and the rate estimate.
+        std::vector<std::shared_ptr<IPacket>> m_batch; ///< The pending batch, oldest first.
+        std::vector<std::shared_ptr<IPacket>> m_spare; ///< Storage of a delivered batch, reused for the next one.
+        std::condition_variable m_turnDone; ///< Signals that a batch was delivered.
+        uint64_t m_nextTurn = 0; ///< Turn of the next batch to be closed.
+        uint64_t m_turn = 0; ///< Turn of the batch allowed to be delivered.
+        std::atomic<uint64_t> m_dropped{0}; ///< Packets the linked pad did not take.
+        uint32_t m_timeout = UINT32_MAX; ///< The smallest timeout of the pending packets.
+        Clock::time_point m_batchStart; ///< Arrival time of the oldest pending packet.
+        Clock::time_point m_lastArrival{}; ///< Arrival time of the last packet.
+        int64_t m_interval; ///< Smoothed time between arrivals, in nanoseconds.
+        std::atomic<size_t> m_target{1}; ///< The current target batch size.
+        IExecutor* m_executor = nullptr; ///< The executor running the flush task, if any.
+        std::atomic_bool m_isRunning{false}; ///< Indicates whether the flush task may run.
+        TaskHandoff m_handoff; ///< Keeps one flush task at a time.
+
+        bool deliver(std::unique_lock<std::mutex>& lock) noexcept;
+        void scheduleFlush(Clock::time_point due) noexcept;
+        void run() noexcept override;
+    };
+
+    /**
+     * @class InputPad
+     * @brief An input pad that only accepts packets of type `T`.
+     *
+     * Packets pushed through the untyped `IPad` interface, one by one or in
+     * batches, are checked once when they enter the pad and rejected if they
+     * are not a `T`. Packets
+     * sent by an `OutputPad` over a typed connection skip the check. Typed
+     * nodes (`Node<T>`, `NodeN`) then receive the packet with a static cast.
+     *
+     * @tparam T The packet type.
+     * @tparam Base The pad implementation, `SimplePad` by default.
+     */
+    template <typename T, typename Base = SimplePad>
+    class InputPad : public Base
+    {
+        static_assert(std::is_base_of_v<IPacket, T>, "InputPad packet type must be derived from IPacket");
+        static_assert(std::is_base_of_v<IPad, Base>, "InputPad base must be a pad");
+
+    public:
+        using ValueType = T; ///< The packet type of the pad.
+
+        /**
+         * @brief Constructor.
+         * @param args Arguments for the constructor of `Base`.
+         */
+        template <typename... Args>
+        explicit InputPad(Args&&... args) : Base(std::forward<Args>(args)...)
+        {
+            this->setPacketKey(packetTypeKey<T>());
+        }
+
+    protected:
+        bool queuePacket(std::shared_ptr<IPacket> packet, uint32_t timeout) noexcept override
+        {
+            if (!packet || !isPacketOf<T>(*packet))
+            {
+                return false; // Packet type mismatch
+            }
+            return Base::queuePacket(std::move(packet), timeout);
+        }
+
+        bool queueCheckedPacket(std::shared_ptr<IPacket> packet, uint32_t timeout) noexcept override
+        {
+            return Base::queuePacket(std::move(packet), timeout);
+        }
+
+        /**
+         * @brief Queues the `T` packets of a batch, in order.
+         *
+         * Packets of another type are moved behind them and left in the span,
+         * like packets the pad did not take.
+         */
+        bool queueBatch(std::span<std::shared_ptr<IPacket>> packets, uint32_t timeout) noexcept override
+        {
+            size_t kept = 0;
+            for (size_t i = 0; i < packets.size(); i++)
+            {
+                if (packets[i] && isPacketOf<T>(*packets[i]))
+                {
+                    std::swap(packets[kept++], packets[i]);
+                }
+            }
+            bool result = Base::queueBatch(packets.first(kept), timeout);
+            return result && kept == packets.size(); // Packet type mismatch
+        }
+    };
+
+    /**
+     * @class OutputPad
+     * @brief An output pad that sends packets of type `T`.
+     *
+     * `pushPacket` only takes `T` packets, so a node cannot send anything
+     * else through it. Connected to an `InputPad` with the typed
+     * `then()` or `Pipeline::connect()`, the packet types are checked at
+     * compile time and packets reach the input pad without a runtime check.
+     *
+     * @tparam T The packet type.
+     */
+    template <typename T>
+    class OutputPad : public SimplePad
+    {
+        static_assert(std::is_base_of_v<IPacket, T>, "OutputPad packet type must be derived from IPacket");
+
+    public:
+        using ValueType = T; ///< The packet type of the pad.
+
+        using IPad::then;
+
+        /**
+         * @brief Connects this pad to a typed input pad.
+         *
+         * Fails to compile if the input pad does not accept `T` packets.
+         *
+         * @param pad The pad to connect to.
+         * @return A reference to the parent node of the connected pad.
+         */
+        template <typename U, typename Base>
+        INode& then(InputPad<U, Base>& pad) noexcept
+        {
+            static_assert(std::is_base_of_v<U, T>, "Packet type of the output pad is not accepted by the input pad");
+            m_checkedPad.store(&pad, std::memory_order_relaxed);
+            return IPad::then(pad);
+        }
+
+        /**
+         * @brief Sends a packet to the connected pad.
+         * @param packet The packet to send.
+         * @param timeout The timeout for the operation, in milliseconds.
+         * @return `true` if the packet was successfully pushed, `false` otherwise.
+         */
+        bool pushPacket(std::shared_ptr<T> packet, uint32_t timeout) noexcept
+        {
+            IPad* pad = linkedPad();
+            if (pad != nullptr && pad == m_checkedPad.load(std::memory_order_relaxed))
+            {
+                return pad->queueCheckedPacket(std::move(packet), timeout);
+            }
+            // Relinked through the untyped interface: the input pad checks the type
+            return IPad::pushPacket(std::move(packet), timeout);
+        }
+
+    private:
+        std::atomic<IPad*> m_checkedPad{nullptr}; ///< Input pad of the last typed connection.
     };
 
 } // namespace lexus2k::pipeline
@@ -0,0 +1,297 @@
+#ifndef LEXUS2K_PIPELINE_RING_H
+#define LEXUS2K_PIPELINE_RING_H
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <thread>
+#include <utility>
+
+namespace lexus2k::pipeline
+{
+    /**
+     * @brief Assumed size of a cache line, used to keep hot indices apart.
+     */
+    inline constexpr size_t CacheLineSize = 64;
+
+    /**
+     * @brief Rounds a capacity up to the next power of two (minimum 2).
+     * @param value The requested capacity.
+     * @return The rounded capacity.
+     */
+    inline constexpr size_t roundUpToPowerOfTwo(size_t value) noexcept
+    {
+        size_t result = 2;
+        while (result < value)
+        {
+            result <<= 1;
+        }
+        return result;
+    }
+
+    /**
+     * @class MpscRing
+     * @brief A bounded lock-free multi-producer/single-consumer ring buffer.
+     *
+     * Every cell carries a sequence number. A producer claims a slot by a CAS
+     * on the enqueue position and publishes the value by advancing the cell
+     * sequence; the single consumer owns the dequeue position and only has to
+     * check the sequence of the next cell. Producers never wait for each other
+     * except on the CAS, and the consumer never takes a lock.
+     *
+     * @tparam T The element type. Must be default constructible and movable.
+     */
+    template <typename T>
+    class MpscRing
+    {
+    public:
+        /**
+         * @brief Constructs the ring.
+         * @param capacity The requested capacity, rounded up to a power of two.
+         */
+        explicit MpscRing(size_t capacity)
+            : m_mask(roundUpToPowerOfTwo(capacity) - 1)
+            , m_cells(new Cell[m_mask + 1])
+        {
+            for (size_t i = 0; i <= m_mask; i++)
+            {
+                m_cells[i].sequence.store(i, std::memory_order_relaxed);
+            }
+        }
+
+        MpscRing(const MpscRing&) = delete;
+        MpscRing& operator=(const MpscRing&) = delete;
+
+        /**
+         * @brief Tries to append an element. Safe to call from any thread.
+         * @param value The element to move into the ring.
+         * @return `true` on success, `false` if the ring is full.
+         */
+        bool tryPush(T&& value) noexcept
+        {
+            size_t pos = m_enqueuePos.load(std::memory_order_relaxed);
+            for (;;)
+            {
+                Cell& cell = m_cells[pos & m_mask];
+                size_t sequence = cell.sequence.load(std::memory_order_acquire);
+                intptr_t diff = static_cast<intptr_t>(sequence) - static_cast<intptr_t>(pos);
+                if (diff == 0)
+                {
+                    if (m_enqueuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+                    {
+                        cell.value = std::move(value);
+                        cell.sequence.store(pos + 1, std::memory_order_release);
+                        return true;
+                    }
+                }
+                else if (diff < 0)
+                {
+                    return false; // Full
+                }
+                else
+                {
+                    pos = m_enqueuePos.load(std::memory_order_relaxed);
+                }
+            }
+        }
+
+        /**
+         * @brief Tries to remove the oldest element. Consumer thread only.
+         * @param value Receives the element.
+         * @return `true` on success, `false` if the ring is empty.
+         */
+        bool tryPop(T& value) noexcept
+        {
+            size_t pos = m_dequeuePos.load(std::memory_order_relaxed);
+            Cell& cell = m_cells[pos & m_mask];
+            if (cell.sequence.load(std::memory_order_acquire) != pos + 1)
+            {
+                return false; // Empty, or the producer has not published yet
+            }
+            value = std::move(cell.value);
+            cell.value = T();
+            cell.sequence.store(pos + m_mask + 1, std::memory_order_release);
+            m_dequeuePos.store(pos + 1, std::memory_order_relaxed);
+            return true;
+        }
+
+        /**
+         * @brief Checks whether the next element is ready. Consumer thread only.
+         */
+        bool empty() const noexcept
+        {
+            size_t pos = m_dequeuePos.load(std::memory_order_relaxed);
+            return m_cells[pos & m_mask].sequence.load(std::memory_order_acquire) != pos + 1;
+        }
+
+        /**
+         * @brief Returns an approximate number of queued elements.
+         */
+        size_t size() const noexcept
+        {
+            size_t head = m_enqueuePos.load(std::memory_order_relaxed);
+            size_t tail = m_dequeuePos.load(std::memory_order_relaxed);
+            return head > tail ? head - tail : 0;
+        }
+
+        /**
+         * @brief Returns the capacity of the ring.
+         */
+        size_t capacity() const noexcept { return m_mask + 1; }
+
+    private:
+        struct Cell
+        {
+            std::atomic<size_t> sequence{0};
+            T value{};
+        };
+
+        const size_t m_mask; ///< Capacity minus one.
+        std::unique_ptr<Cell[]> m_cells; ///< Ring storage.
+        alignas(CacheLineSize) std::atomic<size_t> m_enqueuePos{0}; ///< Shared by producers.
+        alignas(CacheLineSize) std::atomic<size_t> m_dequeuePos{0}; ///< Owned by the consumer.
+    };
+
+    /**
+     * @class SpscRing
+     * @brief A bounded wait-free single-producer/single-consumer ring buffer.
+     *
+     * The producer owns the tail index and the consumer owns the head index.
+     * Both live on separate cache lines, and each side keeps a cached copy of
+     * the other side's index so that it only touches the shared line when
+     * its cached view says the ring is full (or empty).
+     *
+     * @tparam T The element type. Must be default constructible and movable.
+     */
+    template <typename T>
+    class SpscRing
+    {
+    public:
+        /**
+         * @brief Constructs the ring.
+         * @param capacity The requested capacity, rounded up to a power of two.
+         */
+        explicit SpscRing(size_t capacity)
+            : m_mask(roundUpToPowerOfTwo(capacity) - 1)
+            , m_cells(new T[m_mask + 1])
+        {
+        }
+
+        SpscRing(const SpscRing&) = delete;
+        SpscRing& operator=(const SpscRing&) = delete;
+
+        /**
+         * @brief Tries to append an element. Producer thread only.
+         * @param value The element to move into the ring.
+         * @return `true` on success, `false` if the ring is full.
+         */
+        bool tryPush(T&& value) noexcept
+        {
+            size_t tail = m_tail.load(std::memory_order_relaxed);
+            if (tail - m_cachedHead > m_mask)
+            {
+                m_cachedHead = m_head.load(std::memory_order_acquire);
+                if (tail - m_cachedHead > m_mask)
+                {
+                    return false; // Full
+                }
+            }
+            m_cells[tail & m_mask] = std::move(value);
+            m_tail.store(tail + 1, std::memory_order_release);
+            return true;
+        }
+
+        /**
+         * @brief Tries to remove the oldest element. Consumer thread only.
+         * @param value Receives the element.
+         * @return `true` on success, `false` if the ring is empty.
+         */
+        bool tryPop(T& value) noexcept
+        {
+            size_t head = m_head.load(std::memory_order_relaxed);
+            if (head == m_cachedTail)
+            {
+                m_cachedTail = m_tail.load(std::memory_order_acquire);
+                if (head == m_cachedTail)
+                {
+                    return false; // Empty
+                }
+            }
+            value = std::move(m_cells[head & m_mask]);
+            m_cells[head & m_mask] = T();
+            m_head.store(head + 1, std::memory_order_release);
+            return true;
+        }
+
+        /**
+         * @brief Checks whether the ring is empty. Consumer thread only.
+         */
+        bool empty() const noexcept
+        {
+            return m_head.load(std::memory_order_relaxed) == m_tail.load(std::memory_order_acquire);
+        }
+
+        /**
+         * @brief Returns an approximate number of queued elements.
+         */
+        size_t size() const noexcept
+        {
+            size_t tail = m_tail.load(std::memory_order_relaxed);
+            size_t head = m_head.load(std::memory_order_relaxed);
+            return tail > head ? tail - head : 0;
+        }
+
+        /**
+         * @brief Returns the capacity of the ring.
+         */
+        size_t capacity() const noexcept { return m_mask + 1; }
+
+    private:
+        const size_t m_mask; ///< Capacity minus one.
+        std::unique_ptr<T[]> m_cells; ///< Ring storage.
+        alignas(CacheLineSize) std::atomic<size_t> m_head{0}; ///< Written by the consumer.
+        size_t m_cachedTail = 0; ///< Consumer's view of the tail.
+        alignas(CacheLineSize) std::atomic<size_t> m_tail{0}; ///< Written by the producer.
+        size_t m_cachedHead = 0; ///< Producer's view of the head.
+    };
+
+    /**
+     * @brief Pushes an element into a full ring, backing off until the
+     *        consumer frees a slot.
+     *
+     * Producers call it once `tryPush` failed. The sleep between attempts
+     * starts at one microsecond and doubles up to half a millisecond.
+     *
+     * @param ring The ring.
+     * @param value The element to push. It is left in place on failure.
+     * @param deadline When to give up.
+     * @param isOpen Tells whether the consumer still takes elements.
+     *        Checked before each attempt.
+     * @return `true` once the element was pushed, `false` on timeout or
+     *         when the consumer is closed.
+     */
+    template <typename Ring, typename T, typename IsOpen>
+    bool pushWithBackoff(Ring& ring, T& value, std::chrono::steady_clock::time_point deadline, IsOpen&& isOpen) noexcept
+    {
+        auto delay = std::chrono::microseconds(1);
+        for (;;)
+        {
+            if (!isOpen() || std::chrono::steady_clock::now() >= deadline)
+            {
+                return false;
+            }
+            std::this_thread::sleep_for(delay);
+            delay = std::min(delay * 2, std::chrono::microseconds(500));
+            if (ring.tryPush(std::move(value)))
+            {
+                return true;
+            }
+        }
+    }
+
+} // namespace lexus2k::pipeline
+
+#endif // LEXUS2K_PIPELINE_RING_H
@@ -2,6 +2,7 @@
 #define LEXUS2K_PIPELINE_SHAREDMEM_NODE_H__
 
 #include "pipeline_node.h"
+#include "pipeline_packet_pool.h"
 
 #if defined(__linux__) || defined(__APPLE__)
 
@@ -53,7 +54,7 @@ namespace lexus2k::pipeline
     private:
         bool createSharedMem() noexcept;
         void destroySharedMem() noexcept;
-        bool serializeToSharedMem(std::shared_ptr<IPacket> packet, IPad& inputPad) noexcept;
+        bool serializeToSharedMem(const std::shared_ptr<IPacket>& packet, IPad& inputPad) noexcept;
         bool waitForFreeSlot(uint32_t timeoutMs) noexcept;
 
     private:
@@ -103,7 +104,7 @@ namespace lexus2k::pipeline
     protected:
         std::shared_ptr<IPacket> createPacket(IPad& pad) noexcept override
         {
-            return std::make_shared<T>();
+            return PacketPool<T>::make();
         }
     };
 
@@ -0,0 +1,117 @@
+#ifndef LEXUS2K_PIPELINE_TRACE_H
+#define LEXUS2K_PIPELINE_TRACE_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <ostream>
+
+namespace lexus2k::pipeline
+{
+    /**
+     * @enum TraceEvent
+     * @brief Kinds of events recorded by the packet tracer.
+     */
+    enum class TraceEvent : uint8_t
+    {
+        ENQUEUE, ///< A packet was added to a queue. Value: queue size.
+        DEQUEUE, ///< A packet was taken from a queue. Value: queue size.
+        WAIT,    ///< A thread started waiting for a packet or for space.
+        WAKEUP,  ///< A waiting thread was woken up.
+        TIMEOUT, ///< A wait expired. Value: timeout in milliseconds.
+        DROP,    ///< A packet was discarded.
+    };
+
+    /**
+     * @struct TraceRecord
+     * @brief A single binary trace record.
+     */
+    struct TraceRecord
+    {
+        uint64_t timestamp; ///< Monotonic time of the event, in nanoseconds.
+        const void* object; ///< The pad or node that produced the event.
+        uint32_t value;     ///< Event-specific value.
+        TraceEvent event;   ///< The kind of event.
+    };
+
+    /**
+     * @class Trace
+     * @brief Low-overhead binary tracer for the packet path.
+     *
+     * Each thread writes into its own fixed-size ring of `TraceRecord`s, so
+     * recording an event takes no lock and no read-modify-write operation.
+     * Rings are registered on the first event of a thread and outlive the
+     * thread, so they can be dumped post mortem. Old records are overwritten
+     * once a ring wraps.
+     *
+     * Library code records events through the `PIPELINE_TRACE` macro, which
+     * compiles to nothing unless `PIPELINE_ENABLE_TRACE` is defined (CMake
+     * option `BUILD_WITH_TRACE`). When compiled in, recording is still off
+     * until `Trace::enable(true)` is called.
+     */
+    class Trace
+    {
+    public:
+        /**
+         * @brief Number of records kept per thread.
+         */
+        static constexpr size_t RingSize = 4096;
+
+        /**
+         * @brief Enables or disables recording at runtime.
+         * @param enabled `true` to start recording events.
+         */
+        static void enable(bool enabled) noexcept { s_enabled.store(enabled, std::memory_order_relaxed); }
+
+        /**
+         * @brief Tells whether recording is enabled.
+         */
+        static bool isEnabled() noexcept { return s_enabled.load(std::memory_order_relaxed); }
+
+        /**
+         * @brief Records an event in the calling thread's ring.
+         * @param event The kind of event.
+         * @param object The pad or node that produced the event.
+         * @param value Event-specific value.
+         */
+        static void record(TraceEvent event, const void* object, uint32_t value = 0) noexcept;
+
+        /**
+         * @brief Decodes all rings as text, one record per line.
+         *
+         * Records are printed oldest first per thread. The dump is meant to be
+         * taken while the pipeline is idle; records written concurrently may
+         * show up torn.
+         *
+         * @param out The stream to write to.
+         */
+        static void dump(std::ostream& out);
+
+        /**
+         * @brief Discards all recorded events.
+         */
+        static void clear() noexcept;
+
+        /**
+         * @brief Returns the printable name of an event.
+         */
+        static const char* eventName(TraceEvent event) noexcept;
+
+    private:
+        static inline std::atomic_bool s_enabled{false}; ///< Runtime switch.
+    };
+
+} // namespace lexus2k::pipeline
+
+#if defined(PIPELINE_ENABLE_TRACE)
+#define PIPELINE_TRACE(event, object, value) \
+    do { \
+        if (::lexus2k::pipeline::Trace::isEnabled()) { \
+            ::lexus2k::pipeline::Trace::record(::lexus2k::pipeline::TraceEvent::event, (object), (value)); \
+        } \
+    } while (0)
+#else
+#define PIPELINE_TRACE(event, object, value) do { } while (0)
+#endif
+
+#endif // LEXUS2K_PIPELINE_TRACE_H
@@ -1,21 +1,123 @@
 #include "pipeline/pipeline.h"
 
+#include <unordered_map>
+
 namespace lexus2k::pipeline
 {
+    Pipeline::Pipeline(size_t threadCount)
+        : Pipeline(SchedulerType::SHARED_QUEUE, threadCount)
+    {
+    }
+
+    Pipeline::Pipeline(SchedulerType scheduler, size_t threadCount)
+        : m_executor(IExecutor::create(scheduler, threadCount))
+    {
+    }
+
     Pipeline::~Pipeline()
     {
         stop();
     }
 
+    bool Pipeline::compile() noexcept
+    {
+        if (!validateLinks())
+        {
+            return false;
+        }
+
+        std::unordered_map<const INode*, size_t> indices;
+        size_t padCount = 0;
+        for (size_t i = 0; i < m_nodes.size(); i++)
+        {
+            indices[m_nodes[i].get()] = i;
+            padCount += m_nodes[i]->m_pads.size();
+        }
+
+        // Output tables, routes and edges between nodes
+        std::vector<std::vector<size_t>> edges(m_nodes.size());
+        std::vector<size_t> inDegree(m_nodes.size(), 0);
+        m_danglingOutputs.clear();
+        for (size_t i = 0; i < m_nodes.size(); i++)
+        {
+            INode& node = *m_nodes[i];
+            for (auto& pad: node.m_pads)
+            {
+                if (pad.second->getType() != PadType::OUTPUT)
+                {
+                    continue;
+                }
+                // Packets stop at the first buffering pad, the node order
+                // follows the chain to the input pad
+                IPad* sink = resolveRoute(*pad.second, padCount);
+                pad.second->resolveRoute(padCount);
+                if (sink == nullptr)
+                {
+                    m_danglingOutputs.push_back(pad.second.get());
+                    continue;
+                }
+                auto target = indices.find(&sink->node());
+                if (target != indices.end())
+                {
+                    edges[i].push_back(target->second);
+                    inDegree[target->second]++;
+                }
+            }
+        }
+
+        // Kahn's algorithm, keeping the insertion order among ready nodes
+        m_order.clear();
+        std::vector<bool> placed(m_nodes.size(), false);
+        for (size_t i = 0; i < m_nodes.size(); i++)
+        {
+            if (inDegree[i] == 0)
+            {
+                m_order.push_back(m_nodes[i].get());
+                placed[i] = true;
+            }
+        }
+        for (size_t next = 0; next < m_order.size(); next++)
+        {
+            for (size_t target: edges[indices[m_order[next]]])
+            {
+                if (--inDegree[target] == 0)
+                {
+                    m_order.push_back(m_nodes[target].get());
+                    placed[target] = true;
+                }
+            }
+        }
+        m_hasCycles = m_order.size() < m_nodes.size();
+        for (size_t i = 0; i < m_nodes.size(); i++)
+        {
+            if (!placed[i])
+            {
+                m_order.push_back(m_nodes[i].get());
+            }
+        }
+
+        return !m_isStrict || (m_danglingOutputs.empty() && !m_hasCycles);
+    }
+
     bool Pipeline::start() noexcept
     {
-        for (auto node = m_nodes.begin(); node != m_nodes.end(); node++)
+        if (!compile())
+        {
+            return false;
+        }
+        m_executor->start();
+        for (auto& node: m_nodes)
+        {
+            node->m_executor = m_executor.get();
+        }
+        // Consumers first, so that no packet is lost while producers start
+        for (auto node = m_order.rbegin(); node != m_order.rend(); node++)
         {
-            if (!node->get()->_start()) {
-                for (;node != m_nodes.begin();) {
-                    node--;
-                    node->get()->_stop();
+            if (!(*node)->_start()) {
+                for (auto started = node.base(); started != m_order.end(); started++) {
+                    (*started)->_stop();
                 }
+                m_executor->stop();
                 return false;
             }
         }
@@ -24,9 +126,65 @@ namespace lexus2k::pipeline
 
     void Pipeline::stop() noexcept
     {
+        // Producers first, so that none of them pushes into a stopped pad.
+        // Packets still queued when their pad stops are dropped.
+        if (m_order.size() == m_nodes.size())
+        {
+            for (auto* node: m_order)
+            {
+                node->_stop();
+            }
+        }
+        else
+        {
+            for (auto& node: m_nodes)
+            {
+                node->_stop();
+            }
+        }
+        m_executor->stop();
+    }
+
+    void Pipeline::adopt(std::shared_ptr<INode> node)
+    {
+        node->m_linkScope = &m_linkScope;
+        m_nodes.push_back(std::move(node));
+    }
+
+    IPad* Pipeline::resolveRoute(const IPad& pad, size_t maxHops) const noexcept
+    {
+        IPad* target = pad.linkedPad();
+        for (size_t hops = 0; target != nullptr && target->getType() == PadType::OUTPUT; hops++)
+        {
+            if (hops >= maxHops)
+            {
+                return nullptr; // The chain loops through output pads only
+            }
+            target = target->linkedPad();
+        }
+        return target;
+    }
+
+    bool Pipeline::validateLinks() const noexcept
+    {
+        std::unordered_map<const IPad*, size_t> upstreamLinks;
         for (auto& node: m_nodes)
         {
-            node->_stop();
+            for (auto& pad: node->m_pads)
+            {
+                if (auto linked = pad.second->linkedPad())
+                {
+                    upstreamLinks[linked]++;
+                }
+            }
         }
+        for (auto& link: upstreamLinks)
+        {
+            if (link.second > 1 && !link.first->acceptsMultipleProducers())
+            {
+                return false; // Single-producer pad is fed by several pads
+            }
+        }
+        return true;
     }
 }
\ No newline at end of file
@@ -0,0 +1,468 @@
+#include "pipeline/pipeline_executor.h"
+
+namespace lexus2k::pipeline
+{
+    std::unique_ptr<IExecutor> IExecutor::create(SchedulerType type, size_t threadCount)
+    {
+        switch (type)
+        {
+            case SchedulerType::WORK_STEALING:
+                return std::make_unique<WorkStealingExecutor>(threadCount);
+            case SchedulerType::SHARED_QUEUE:
+                break;
+        }
+        return std::make_unique<Executor>(threadCount);
+    }
+
+    /// @brief Timer queue
+
+    void TimerQueue::add(ITask& task, std::chrono::steady_clock::time_point when) noexcept
+    {
+        bool isEarliest;
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            // The helper thread is created lazily, on the first timed task
+            if (!m_thread.joinable())
+            {
+                m_thread = std::thread(&TimerQueue::threadBody, this);
+            }
+            isEarliest = m_tasks.emplace(when, &task) == m_tasks.begin();
+        }
+        if (isEarliest)
+        {
+            m_changed.notify_one();
+        }
+    }
+
+    bool TimerQueue::cancel(ITask& task) noexcept
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        for (auto it = m_tasks.begin(); it != m_tasks.end(); ++it)
+        {
+            if (it->second == &task)
+            {
+                m_tasks.erase(it);
+                return true;
+            }
+        }
+        return false;
+    }
+
+    void TimerQueue::stop() noexcept
+    {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_isStopping = true;
+            m_tasks.clear();
+        }
+        m_changed.notify_all();
+        if (m_thread.joinable())
+        {
+            m_thread.join();
+        }
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_isStopping = false;
+    }
+
+    void TimerQueue::threadBody() noexcept
+    {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        while (!m_isStopping)
+        {
+            if (m_tasks.empty())
+            {
+                m_changed.wait(lock);
+                continue;
+            }
+            auto first = m_tasks.begin();
+            if (first->first > std::chrono::steady_clock::now())
+            {
+                m_changed.wait_until(lock, first->first);
+                continue;
+            }
+            ITask* task = first->second;
+            m_tasks.erase(first);
+            lock.unlock();
+            m_executor.schedule(*task);
+            lock.lock();
+        }
+    }
+
+    /// @brief Shared queue executor
+
+    static size_t defaultThreadCount(size_t threadCount) noexcept
+    {
+        if (threadCount == 0)
+        {
+            threadCount = std::thread::hardware_concurrency();
+        }
+        return threadCount == 0 ? 1 : threadCount;
+    }
+
+    Executor::Executor(size_t threadCount)
+        : m_threadCount(defaultThreadCount(threadCount))
+    {
+    }
+
+    Executor::~Executor()
+    {
+        stop();
+    }
+
+    bool Executor::start() noexcept
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_isRunning = true;
+        return true;
+    }
+
+    void Executor::stop() noexcept
+    {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_isRunning = false;
+            m_tasks.clear();
+        }
+        m_timers.stop();
+        m_hasTasks.notify_all();
+        for (auto& thread: m_threads)
+        {
+            thread.join();
+        }
+        m_threads.clear();
+    }
+
+    bool Executor::isRunning() const noexcept
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return m_isRunning;
+    }
+
+    bool Executor::schedule(ITask& task) noexcept
+    {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            if (!m_isRunning)
+            {
+                return false;
+            }
+            // Workers are created lazily, on the first task
+            while (m_threads.size() < m_threadCount)
+            {
+                m_threads.emplace_back(&Executor::threadBody, this);
+            }
+            m_tasks.push_back(&task);
+        }
+        m_hasTasks.notify_one();
+        return true;
+    }
+
+    bool Executor::scheduleAt(ITask& task, std::chrono::steady_clock::time_point when) noexcept
+    {
+        if (!isRunning())
+        {
+            return false;
+        }
+        if (when <= std::chrono::steady_clock::now())
+        {
+            return schedule(task);
+        }
+        m_timers.add(task, when);
+        return true;
+    }
+
+    void Executor::threadBody() noexcept
+    {
+        for (;;)
+        {
+            ITask* task = nullptr;
+            {
+                std::unique_lock<std::mutex> lock(m_mutex);
+                m_hasTasks.wait(lock, [this] { return !m_isRunning || !m_tasks.empty(); });
+                if (!m_isRunning)
+                {
+                    break;
+                }
+                task = m_tasks.front();
+                m_tasks.pop_front();
+            }
+            task->run();
+        }
+    }
+
+    /// @brief Work-stealing executor
+
+    // Number of empty polls before a worker goes to sleep
+    static constexpr int STEAL_SPIN_COUNT = 32;
+
+    namespace
+    {
+        struct CurrentWorker
+        {
+            const WorkStealingExecutor* owner = nullptr;
+            size_t index = 0;
+        };
+
+        thread_local CurrentWorker t_currentWorker; ///< Worker running on this thread, if any.
+    }
+
+    bool WorkStealingExecutor::TaskDeque::push(ITask* task) noexcept
+    {
+        int64_t bottom = m_bottom.load(std::memory_order_relaxed);
+        int64_t top = m_top.load(std::memory_order_acquire);
+        if (bottom - top >= Capacity)
+        {
+            return false; // Full
+        }
+        m_tasks[bottom & (Capacity - 1)].store(task, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        m_bottom.store(bottom + 1, std::memory_order_relaxed);
+        return true;
+    }
+
+    ITask* WorkStealingExecutor::TaskDeque::pop() noexcept
+    {
+        int64_t bottom = m_bottom.load(std::memory_order_relaxed) - 1;
+        m_bottom.store(bottom, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        int64_t top = m_top.load(std::memory_order_relaxed);
+        if (top > bottom)
+        {
+            m_bottom.store(bottom + 1, std::memory_order_relaxed);
+            return nullptr; // Empty
+        }
+        ITask* task = m_tasks[bottom & (Capacity - 1)].load(std::memory_order_relaxed);
+        if (top == bottom)
+        {
+            // Last task: race against thieves for it
+            if (!m_top.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst, std::memory_order_relaxed))
+            {
+                task = nullptr;
+            }
+            m_bottom.store(bottom + 1, std::memory_order_relaxed);
+        }
+        return task;
+    }
+
+    ITask* WorkStealingExecutor::TaskDeque::steal() noexcept
+    {
+        int64_t top = m_top.load(std::memory_order_acquire);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        int64_t bottom = m_bottom.load(std::memory_order_acquire);
+        if (top >= bottom)
+        {
+            return nullptr; // Empty
+        }
+        ITask* task = m_tasks[top & (Capacity - 1)].load(std::memory_order_relaxed);
+        if (!m_top.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst, std::memory_order_relaxed))
+        {
+            return nullptr; // Lost the race to the owner or another thief
+        }
+        return task;
+    }
+
+    bool WorkStealingExecutor::TaskDeque::empty() const noexcept
+    {
+        return m_top.load(std::memory_order_acquire) >= m_bottom.load(std::memory_order_acquire);
+    }
+
+    void WorkStealingExecutor::TaskDeque::clear() noexcept
+    {
+        m_top.store(0, std::memory_order_relaxed);
+        m_bottom.store(0, std::memory_order_relaxed);
+    }
+
+    WorkStealingExecutor::WorkStealingExecutor(size_t threadCount)
+    {
+        threadCount = defaultThreadCount(threadCount);
+        for (size_t i = 0; i < threadCount; i++)
+        {
+            m_workers.push_back(std::make_unique<Worker>());
+        }
+    }
+
+    WorkStealingExecutor::~WorkStealingExecutor()
+    {
+        stop();
+    }
+
+    bool WorkStealingExecutor::start() noexcept
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_isRunning.store(true, std::memory_order_release);
+        return true;
+    }
+
+    void WorkStealingExecutor::stop() noexcept
+    {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_isRunning.store(false, std::memory_order_release);
+            m_injected.clear();
+            m_hasInjected.store(false, std::memory_order_relaxed);
+        }
+        m_timers.stop();
+        m_wakeups.fetch_add(1, std::memory_order_release);
+        m_wakeups.notify_all();
+        for (auto& worker: m_workers)
+        {
+            if (worker->thread.joinable())
+            {
+                worker->thread.join();
+            }
+            worker->deque.clear();
+        }
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_threadsStarted = false;
+    }
+
+    bool WorkStealingExecutor::isRunning() const noexcept
+    {
+        return m_isRunning.load(std::memory_order_acquire);
+    }
+
+    bool WorkStealingExecutor::scheduleAt(ITask& task, std::chrono::steady_clock::time_point when) noexcept
+    {
+        if (!isRunning())
+        {
+            return false;
+        }
+        if (when <= std::chrono::steady_clock::now())
+        {
+            return schedule(task);
+        }
+        m_timers.add(task, when);
+        return true;
+    }
+
+    bool WorkStealingExecutor::schedule(ITask& task) noexcept
+    {
+        if (!m_isRunning.load(std::memory_order_acquire))
+        {
+            return false;
+        }
+        // Keep work produced on a worker local to that worker
+        if (t_currentWorker.owner == this && m_workers[t_currentWorker.index]->deque.push(&task))
+        {
+            wakeWorker();
+            return true;
+        }
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            if (!m_isRunning.load(std::memory_order_relaxed))
+            {
+                return false;
+            }
+            // Workers are created lazily, on the first task
+            if (!m_threadsStarted)
+            {
+                for (size_t i = 0; i < m_workers.size(); i++)
+                {
+                    m_workers[i]->thread = std::thread(&WorkStealingExecutor::threadBody, this, i);
+                }
+                m_threadsStarted = true;
+            }
+            m_injected.push_back(&task);
+            m_hasInjected.store(true, std::memory_order_relaxed);
+        }
+        wakeWorker();
+        return true;
+    }
+
+    void WorkStealingExecutor::wakeWorker() noexcept
+    {
+        // Pairs with the fence of a worker going to sleep
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (m_sleepers.load(std::memory_order_relaxed) != 0)
+        {
+            m_wakeups.fetch_add(1, std::memory_order_release);
+            m_wakeups.notify_one();
+        }
+    }
+
+    ITask* WorkStealingExecutor::takeInjected() noexcept
+    {
+        if (!m_hasInjected.load(std::memory_order_relaxed))
+        {
+            return nullptr;
+        }
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (m_injected.empty())
+        {
+            return nullptr;
+        }
+        ITask* task = m_injected.front();
+        m_injected.pop_front();
+        m_hasInjected.store(!m_injected.empty(), std::memory_order_relaxed);
+        return task;
+    }
+
+    ITask* WorkStealingExecutor::findTask(size_t index) noexcept
+    {
+        if (ITask* task = m_workers[index]->deque.pop())
+        {
+            return task;
+        }
+        if (ITask* task = takeInjected())
+        {
+            return task;
+        }
+        // Steal the oldest task of another worker, starting with the next one
+        for (size_t i = 1; i < m_workers.size(); i++)
+        {
+            if (ITask* task = m_workers[(index + i) % m_workers.size()]->deque.steal())
+            {
+                return task;
+            }
+        }
+        return nullptr;
+    }
+
+    bool WorkStealingExecutor::hasWork() const noexcept
+    {
+        if (m_hasInjected.load(std::memory_order_relaxed))
+        {
+            return true;
+        }
+        for (auto& worker: m_workers)
+        {
+            if (!worker->deque.empty())
+            {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    void WorkStealingExecutor::threadBody(size_t index) noexcept
+    {
+        t_currentWorker = CurrentWorker{this, index};
+        int idle = 0;
+        while (m_isRunning.load(std::memory_order_acquire))
+        {
+            if (ITask* task = findTask(index))
+            {
+                idle = 0;
+                task->run();
+                continue;
+            }
+            if (++idle < STEAL_SPIN_COUNT)
+            {
+                std::this_thread::yield();
+                continue;
+            }
+
+            // Nothing to run or steal: sleep until new work is scheduled
+            uint32_t ticket = m_wakeups.load(std::memory_order_acquire);
+            m_sleepers.fetch_add(1, std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            if (!hasWork() && m_isRunning.load(std::memory_order_acquire))
+            {
+                m_wakeups.wait(ticket, std::memory_order_acquire);
+            }
+            m_sleepers.fetch_sub(1, std::memory_order_relaxed);
+            idle = 0;
+        }
+        t_currentWorker = CurrentWorker{};
+    }
+}
\ No newline at end of file
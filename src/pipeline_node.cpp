@@ -1,5 +1,9 @@
 #include "pipeline/pipeline_node.h"
 
+#include <algorithm>
+#include <cstdint>
+#include <stdexcept>
+
 namespace lexus2k::pipeline
 {
     bool INode::_start() noexcept
@@ -37,7 +41,39 @@ namespace lexus2k::pipeline
         {
             return false; // Pad not found
         }
-        return pad->pushPacket(packet, timeout);
+        return pad->pushPacket(std::move(packet), timeout);
+    }
+
+    bool INode::pushPacket(PadId id, std::shared_ptr<IPacket> packet, uint32_t timeout) const noexcept
+    {
+        auto* pad = getPadByIndex(id.index());
+        if (!pad)
+        {
+            return false; // Pad not found
+        }
+        return pad->pushPacket(std::move(packet), timeout);
+    }
+
+    size_t INode::headroom(size_t hops) const noexcept
+    {
+        // Outputs without a link take no part, unless no output has one
+        size_t result = SIZE_MAX;
+        bool isLinked = m_outputs.empty();
+        for (auto* pad: m_outputs)
+        {
+            if (pad->linkedPad() != nullptr)
+            {
+                result = std::min(result, pad->headroom(hops + 1));
+                isLinked = true;
+            }
+        }
+        return isLinked ? result : 0;
+    }
+
+    PadId INode::padId(const std::string& name, PadType type) const noexcept
+    {
+        auto* pad = getPadByName(name, type);
+        return pad ? PadId(pad->getIndex()) : PadId();
     }
 
     IPad& INode::operator[](const std::string &name) const
@@ -63,11 +99,32 @@ namespace lexus2k::pipeline
     // Helper method to find a pad by name
     IPad* INode::getPadByName(const std::string& name, PadType type) const noexcept
     {
-        auto it = std::find_if(m_pads.begin(), m_pads.end(),
-            [&name, &type](const auto& pair) {
-                return pair.first == name && (type == PadType::UNDEFINED || pair.second->getType() == type);
-            });
-        return it != m_pads.end() ? it->second.get() : nullptr;
+        // Several pads may share a name: the first one added wins
+        IPad* found = nullptr;
+        auto range = m_padNames.equal_range(name);
+        for (auto it = range.first; it != range.second; ++it)
+        {
+            IPad* pad = m_pads[it->second].second.get();
+            if ((type == PadType::UNDEFINED || pad->getType() == type) &&
+                (found == nullptr || pad->getIndex() < found->getIndex()))
+            {
+                found = pad;
+            }
+        }
+        return found;
+    }
+
+    void INode::addPad(const std::string& name, std::shared_ptr<IPad> pad, PadType type)
+    {
+        pad->setType(type);
+        pad->setParent(this);
+        pad->setIndex(m_pads.size());
+        m_padNames.emplace(name, m_pads.size());
+        if (type == PadType::OUTPUT)
+        {
+            m_outputs.push_back(pad.get());
+        }
+        m_pads.emplace_back(name, std::move(pad));
     }
 
     IPad* INode::getPadByIndex(size_t index) const noexcept
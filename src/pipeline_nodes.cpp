@@ -1,21 +1,733 @@
 #include "pipeline/pipeline_nodes.h"
+#include "pipeline/pipeline_ring.h"
+#include "pipeline/pipeline_trace.h"
+#include <algorithm>
+#include <chrono>
 #include <iostream>
+#include <thread>
 
 namespace lexus2k::pipeline
 {
+    // Number of packets a lane task forwards before yielding the worker
+    static constexpr int LANE_TASK_PACKETS = 64;
+
+    // Number of packets the merger drain task forwards before yielding the worker
+    static constexpr int MERGE_TASK_PACKETS = 64;
+
+    /**
+     * @brief Buffers the packets of one splitter output and pushes them to
+     *        the output from an executor task.
+     */
+    class ISplitter::Lane : public ITask
+    {
+    public:
+        Lane(IPad& output, IExecutor& executor, size_t capacity)
+            : m_output(output)
+            , m_executor(executor)
+            , m_ring(capacity)
+        {
+        }
+
+        bool push(std::shared_ptr<IPacket> packet, uint32_t timeout) noexcept
+        {
+            if (!m_isRunning.load(std::memory_order_relaxed) || !m_ring.tryPush({timeout, std::move(packet)}))
+            {
+                PIPELINE_TRACE(DROP, this, 0);
+                return false; // Never wait, whatever the timeout: the other outputs must not be delayed
+            }
+            m_handoff.schedule(m_executor, *this);
+            return true;
+        }
+
+        void stop() noexcept
+        {
+            m_isRunning.store(false, std::memory_order_relaxed);
+            m_handoff.wait();
+            std::pair<uint32_t, std::shared_ptr<IPacket>> item;
+            while (m_ring.tryPop(item))
+            {
+            }
+        }
+
+    private:
+        IPad& m_output; ///< The splitter output fed by the lane.
+        IExecutor& m_executor; ///< The executor running the lane.
+        MpscRing<std::pair<uint32_t, std::shared_ptr<IPacket>>> m_ring; ///< Packets waiting for delivery.
+        std::atomic_bool m_isRunning{true}; ///< Cleared when the splitter stops.
+        TaskHandoff m_handoff; ///< Keeps one lane task at a time.
+
+        void run() noexcept override
+        {
+            std::pair<uint32_t, std::shared_ptr<IPacket>> item;
+            for (int count = 0; count < LANE_TASK_PACKETS; count++)
+            {
+                if (!m_isRunning.load(std::memory_order_relaxed) || !m_ring.tryPop(item))
+                {
+                    break;
+                }
+                if (!m_output.pushPacket(std::move(item.second), item.first))
+                {
+                    PIPELINE_TRACE(DROP, this, 1); // Rejected by the output
+                }
+            }
+
+            // Give up the lane, then make sure no packet slipped in meanwhile
+            m_handoff.finish(m_executor, *this, [this]() {
+                return m_isRunning.load(std::memory_order_relaxed) && !m_ring.empty();
+            });
+        }
+    };
+
+    ISplitter::ISplitter(SplitterMode mode, size_t laneCapacity)
+        : INode()
+        , m_mode(mode)
+        , m_laneCapacity(laneCapacity)
+    {
+    }
+
+    ISplitter::~ISplitter() = default;
+
+    bool ISplitter::start() noexcept
+    {
+        m_lanes.clear();
+        IExecutor* exec = executor();
+        if (m_mode == SplitterMode::PARALLEL && exec != nullptr && exec->isRunning()) {
+            for (auto* pad: outputs()) {
+                m_lanes.push_back(std::make_unique<Lane>(*pad, *exec, m_laneCapacity));
+            }
+        }
+        return true;
+    }
+
+    void ISplitter::stop() noexcept
+    {
+        // The lanes are released on the next start: a finishing task may
+        // still touch its lane after the wait
+        for (auto& lane: m_lanes) {
+            lane->stop();
+        }
+    }
+
     bool ISplitter::processPacket(std::shared_ptr<IPacket> packet, IPad& inputPad, uint32_t timeoutMs) noexcept
     {
+        auto& targets = outputs();
+        size_t count = targets.size();
+        if (count == 0) {
+            return true;
+        }
         bool result = true;
-        // Process the packet and send it to all output pads
-        for(size_t index = 0;; index++) {
-            auto pad = getPadByIndex(index);
-            if (pad == nullptr) {
-                break; // No more pads
+        if (!m_lanes.empty()) {
+            for (size_t i = 0; i + 1 < count; i++) {
+                result = m_lanes[i]->push(packet, timeoutMs) && result;
+            }
+            return m_lanes[count - 1]->push(std::move(packet), timeoutMs) && result;
+        }
+        for (size_t i = 0; i + 1 < count; i++) {
+            result = targets[i]->pushPacket(packet, timeoutMs) && result;
+        }
+        // Only the copies for the other outputs touch the reference count
+        return targets[count - 1]->pushPacket(std::move(packet), timeoutMs) && result;
+    }
+
+    /// @brief Merger
+
+    /**
+     * @brief An input of the merger: a single-producer lane drained by the
+     *        merger task.
+     */
+    class IMerger::LanePad : public IPad
+    {
+    public:
+        struct Item
+        {
+            uint64_t timestamp = 0; ///< Arrival time, only set in timestamp order.
+            uint32_t timeout = 0; ///< The timeout the packet was pushed with.
+            std::shared_ptr<IPacket> packet; ///< The packet.
+        };
+
+        LanePad(IMerger& merger, size_t capacity) : IPad(), m_merger(merger), m_ring(capacity) {}
+
+        bool acceptsMultipleProducers() const noexcept override { return false; }
+
+        size_t queueDepth() const noexcept override { return m_ring.size(); }
+
+        size_t queueCapacity() const noexcept override { return m_ring.capacity(); }
+
+        // Safe to call from any thread: only reads the ring indices
+        bool hasQueued() const noexcept { return !m_ring.empty(); }
+
+        // Consumer side, only called from the drain task
+
+        Item* front() noexcept
+        {
+            if (!m_hasFront)
+            {
+                m_hasFront = m_ring.tryPop(m_front);
             }
-            if (pad->getType() == PadType::OUTPUT) {
-                result = pad->pushPacket(packet, timeoutMs) && result;
+            return m_hasFront ? &m_front : nullptr;
+        }
+
+        bool hasFront() const noexcept { return m_hasFront; }
+
+        Item take() noexcept
+        {
+            m_hasFront = false;
+            return std::move(m_front);
+        }
+
+        void clear() noexcept
+        {
+            m_hasFront = false;
+            m_front = Item();
+            Item item;
+            while (m_ring.tryPop(item))
+            {
             }
         }
+
+    protected:
+        bool queuePacket(std::shared_ptr<IPacket> packet, uint32_t timeout) noexcept override
+        {
+            if (!m_merger.m_isRunning.load(std::memory_order_relaxed))
+            {
+                return false;
+            }
+            Item item{0, timeout, std::move(packet)};
+            if (m_merger.m_policy == MergePolicy::TIMESTAMP)
+            {
+                item.timestamp = std::chrono::steady_clock::now().time_since_epoch().count();
+            }
+            // The lane is full: back off until the drain task frees a slot
+            if (!m_ring.tryPush(std::move(item)) &&
+                !pushWithBackoff(m_ring, item, std::chrono::steady_clock::now() + std::chrono::milliseconds(timeout),
+                    [this] { return m_merger.m_isRunning.load(std::memory_order_relaxed); }))
+            {
+                PIPELINE_TRACE(TIMEOUT, this, timeout);
+                return false; // Timeout or merger is not running
+            }
+            PIPELINE_TRACE(ENQUEUE, this, static_cast<uint32_t>(m_ring.size()));
+            m_merger.notifyPacket();
+            return true;
+        }
+
+    private:
+        IMerger& m_merger; ///< The merger owning the lane.
+        SpscRing<Item> m_ring; ///< Packets waiting to be merged.
+        Item m_front; ///< The oldest packet, taken out of the ring but not merged yet.
+        bool m_hasFront = false; ///< Tells whether `m_front` holds a packet.
+    };
+
+    IMerger::IMerger(size_t inputs, MergePolicy policy, size_t laneCapacity)
+        : INode()
+        , m_policy(policy)
+    {
+        for (size_t i = 1; i <= inputs; i++)
+        {
+            m_lanes.push_back(&addInput<LanePad>("input_" + std::to_string(i), *this, laneCapacity));
+        }
+        m_output = &addOutput("output");
+    }
+
+    IMerger::~IMerger() = default;
+
+    bool IMerger::start() noexcept
+    {
+        IExecutor* exec = executor();
+        if (exec == nullptr || !exec->isRunning())
+        {
+            return false; // The drain task needs an executor
+        }
+        m_next = 0;
+        m_handoff.reset();
+        m_isRunning.store(true, std::memory_order_release);
+        return true;
+    }
+
+    void IMerger::stop() noexcept
+    {
+        m_isRunning.store(false, std::memory_order_relaxed);
+        m_handoff.wait();
+        for (auto* lane: m_lanes)
+        {
+            lane->clear();
+        }
+    }
+
+    bool IMerger::processPacket(std::shared_ptr<IPacket> packet, IPad& inputPad, uint32_t timeoutMs) noexcept
+    {
+        return false; // Lanes never call into the node
+    }
+
+    void IMerger::notifyPacket() noexcept
+    {
+        m_handoff.schedule(*executor(), *this);
+    }
+
+    IMerger::LanePad* IMerger::nextLane() noexcept
+    {
+        size_t count = m_lanes.size();
+        switch (m_policy)
+        {
+        case MergePolicy::ROUND_ROBIN:
+            for (size_t i = 0; i < count; i++)
+            {
+                size_t index = (m_next + i) % count;
+                if (m_lanes[index]->front() != nullptr)
+                {
+                    m_next = (index + 1) % count;
+                    return m_lanes[index];
+                }
+            }
+            return nullptr;
+        case MergePolicy::PRIORITY:
+            for (auto* lane: m_lanes)
+            {
+                if (lane->front() != nullptr)
+                {
+                    return lane;
+                }
+            }
+            return nullptr;
+        case MergePolicy::TIMESTAMP:
+        default:
+        {
+            LanePad* oldest = nullptr;
+            for (auto* lane: m_lanes)
+            {
+                auto* item = lane->front();
+                if (item != nullptr && (oldest == nullptr || item->timestamp < oldest->front()->timestamp))
+                {
+                    oldest = lane;
+                }
+            }
+            return oldest;
+        }
+        }
+    }
+
+    void IMerger::run() noexcept
+    {
+        for (int count = 0; count < MERGE_TASK_PACKETS && m_isRunning.load(std::memory_order_relaxed); count++)
+        {
+            LanePad* lane = nextLane();
+            if (lane == nullptr)
+            {
+                break;
+            }
+            auto item = lane->take();
+            if (item.packet && item.packet->hasDeadline() && item.packet->isExpired())
+            {
+                PIPELINE_TRACE(DROP, this, 1);
+                continue; // Went stale in the lane
+            }
+            m_output->pushPacket(std::move(item.packet), item.timeout);
+        }
+
+        // Packets already taken out of a ring belong to this task until it
+        // gives up: check them before, and only the ring indices after
+        bool pending = std::any_of(m_lanes.begin(), m_lanes.end(), [](LanePad* lane) { return lane->hasFront(); });
+
+        // Give up the task, then recheck the lanes
+        m_handoff.finish(*executor(), *this, [this, pending]() {
+            return m_isRunning.load(std::memory_order_relaxed) &&
+                (pending || std::any_of(m_lanes.begin(), m_lanes.end(), [](LanePad* lane) { return lane->hasQueued(); }));
+        });
+    }
+
+    /// @brief Dispatcher
+
+    Dispatcher::Dispatcher(size_t outputs, DispatchPolicy policy, KeyFunction key)
+        : INode()
+        , m_policy(policy)
+        , m_key(std::move(key))
+    {
+        addInput("input");
+        for (size_t i = 1; i <= outputs; i++)
+        {
+            addOutput("output_" + std::to_string(i));
+        }
+    }
+
+    void Dispatcher::setPolicy(DispatchPolicy policy, KeyFunction key)
+    {
+        m_policy = policy;
+        m_key = std::move(key);
+    }
+
+    size_t Dispatcher::headroom(size_t hops) const noexcept
+    {
+        size_t result = 0;
+        for (auto* pad: outputs())
+        {
+            size_t space = pad->headroom(hops + 1);
+            result = space > SIZE_MAX - result ? SIZE_MAX : result + space;
+        }
         return result;
     }
-}
\ No newline at end of file
+
+    bool Dispatcher::start() noexcept
+    {
+        if (m_policy == DispatchPolicy::KEY_HASH && !m_key)
+        {
+            return false; // Nothing to hash
+        }
+        return !outputs().empty();
+    }
+
+    size_t Dispatcher::leastLoaded() noexcept
+    {
+        auto& targets = outputs();
+        size_t count = targets.size();
+        size_t first = m_next.fetch_add(1, std::memory_order_relaxed);
+        size_t best = first % count;
+        size_t bestDepth = SIZE_MAX;
+        for (size_t i = 0; i < count && bestDepth != 0; i++)
+        {
+            size_t index = (first + i) % count;
+            IPad* linked = targets[index]->linkedPad();
+            // Packets the replica is working on count too: a stuck replica with
+            // an empty buffer is not idle
+            size_t depth = linked ? linked->queueDepth() + linked->inFlight() : SIZE_MAX;
+            if (depth < bestDepth)
+            {
+                best = index;
+                bestDepth = depth;
+            }
+        }
+        return best;
+    }
+
+    bool Dispatcher::processPacket(std::shared_ptr<IPacket> packet, IPad& inputPad, uint32_t timeoutMs) noexcept
+    {
+        size_t count = outputs().size();
+        if (count == 0)
+        {
+            return false; // Not started, or nothing to dispatch to
+        }
+        size_t index;
+        switch (m_policy)
+        {
+        case DispatchPolicy::LEAST_LOADED:
+            index = leastLoaded();
+            break;
+        case DispatchPolicy::KEY_HASH:
+            if (!packet)
+            {
+                return false; // A missing packet has no key
+            }
+            index = m_key(*packet) % count;
+            break;
+        case DispatchPolicy::ROUND_ROBIN:
+        default:
+            index = m_next.fetch_add(1, std::memory_order_relaxed) % count;
+            break;
+        }
+        return outputs()[index]->pushPacket(std::move(packet), timeoutMs);
+    }
+
+    /// @brief Sequencer
+
+    Sequencer::Sequencer(size_t window, uint32_t gapTimeoutMs, GapPolicy policy)
+        : INode()
+        , m_policy(policy)
+        , m_gapTimeout(gapTimeoutMs)
+        , m_window(roundUpToPowerOfTwo(window))
+    {
+        m_input = &addInput("input");
+        m_fanOut = &addOutput("fanout");
+        m_fanIn = &addInput("fanin");
+        m_output = &addOutput("output");
+        // Window slots and unsent packets never add up to more than the window
+        m_ready.reserve(m_window.size());
+        m_sending.reserve(m_window.size());
+        m_pruneAt = m_window.size() * 2;
+    }
+
+    std::shared_ptr<IPacket> Sequencer::stamp(uint64_t sequence, std::shared_ptr<IPacket> packet)
+    {
+        std::weak_ptr<IPacket> original = packet;
+        IPacket* raw = packet.get();
+        // A control block of its own: the last copy of the stamped pointer releases the packet
+        std::shared_ptr<IPacket> stamped(raw, [packet = std::move(packet)](IPacket*) mutable { packet.reset(); });
+
+        std::lock_guard<std::mutex> lock(m_stampMutex);
+        if (m_stamps.size() >= m_pruneAt)
+        {
+            // Forget packets dropped inside the parallel section
+            std::erase_if(m_stamps, [](const auto& entry) { return entry.first.expired(); });
+            m_pruneAt = std::max(m_stamps.size() * 2, m_window.size() * 2);
+        }
+        m_stamps.emplace(stamped, Stamp{sequence, std::move(original)});
+        return stamped;
+    }
+
+    bool Sequencer::takeStamp(const std::shared_ptr<IPacket>& packet, uint64_t& sequence, std::shared_ptr<IPacket>& original) noexcept
+    {
+        std::lock_guard<std::mutex> lock(m_stampMutex);
+        auto it = m_stamps.find(packet);
+        if (it == m_stamps.end())
+        {
+            return false;
+        }
+        sequence = it->second.sequence;
+        original = it->second.packet.lock();
+        m_stamps.erase(it);
+        return original != nullptr;
+    }
+
+    bool Sequencer::sequenceOf(const std::shared_ptr<IPacket>& packet, uint64_t& sequence) noexcept
+    {
+        std::lock_guard<std::mutex> lock(m_stampMutex);
+        auto it = m_stamps.find(packet);
+        if (it == m_stamps.end())
+        {
+            return false;
+        }
+        sequence = it->second.sequence;
+        return true;
+    }
+
+    std::shared_ptr<IPacket> Sequencer::carryStamp(const std::shared_ptr<IPacket>& from, std::shared_ptr<IPacket> to)
+    {
+        uint64_t sequence = 0;
+        if (!sequenceOf(from, sequence))
+        {
+            return to;
+        }
+        return stamp(sequence, std::move(to));
+    }
+
+    bool Sequencer::start() noexcept
+    {
+        {
+            std::lock_guard<std::mutex> lock(m_stampMutex);
+            m_stamps.clear();
+        }
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stamp.store(0, std::memory_order_relaxed);
+        m_next = 0;
+        m_buffered = 0;
+        m_handoff.reset();
+        m_isRunning = true;
+        return true;
+    }
+
+    void Sequencer::stop() noexcept
+    {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_isRunning = false;
+        }
+        m_hasSpace.notify_all();
+        // Take back a gap timer waiting for its time, or wait for it to finish
+        if (IExecutor* exec = executor(); exec != nullptr)
+        {
+            m_handoff.cancel(*exec, *this);
+        }
+        m_handoff.wait();
+
+        std::lock_guard<std::mutex> lock(m_mutex);
+        for (auto& slot: m_window)
+        {
+            slot.reset();
+        }
+        m_buffered = 0;
+        m_unsent -= m_ready.size(); // Packets being pushed are counted off by their thread
+        m_ready.clear();
+
+        std::lock_guard<std::mutex> stampLock(m_stampMutex);
+        m_stamps.clear();
+    }
+
+    void Sequencer::flush(uint32_t timeoutMs) noexcept
+    {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        while (m_buffered > 0)
+        {
+            skipGap();
+        }
+        emit(lock, timeoutMs);
+        // Another thread may still be pushing packets taken before
+        m_hasSpace.wait(lock, [this] { return !m_isEmitting; });
+    }
+
+    bool Sequencer::processPacket(std::shared_ptr<IPacket> packet, IPad& inputPad, uint32_t timeoutMs) noexcept
+    {
+        if (&inputPad == m_fanIn)
+        {
+            return reorder(std::move(packet), timeoutMs);
+        }
+        auto stamped = stamp(m_stamp.fetch_add(1, std::memory_order_relaxed), std::move(packet));
+        return m_fanOut->pushPacket(std::move(stamped), timeoutMs);
+    }
+
+    bool Sequencer::reorder(std::shared_ptr<IPacket> packet, uint32_t timeoutMs) noexcept
+    {
+        // The window keeps the packet without the stamp
+        uint64_t sequence = 0;
+        if (!takeStamp(packet, sequence, packet))
+        {
+            PIPELINE_TRACE(DROP, this, 0); // Not stamped by this sequencer, or a duplicate
+            return false;
+        }
+
+        std::unique_lock<std::mutex> lock(m_mutex);
+        const size_t capacity = m_window.size();
+        const size_t mask = capacity - 1;
+        bool result = true;
+
+        if (!m_isRunning || sequence < m_next)
+        {
+            PIPELINE_TRACE(DROP, this, static_cast<uint32_t>(sequence)); // Late: its turn was skipped
+            return false;
+        }
+        m_lastTimeout = timeoutMs;
+
+        if (m_policy == GapPolicy::SKIP && sequence >= m_next + capacity)
+        {
+            // Give up on the oldest gaps until the packet fits
+            while (m_buffered > 0 && sequence >= m_next + capacity)
+            {
+                skipGap();
+            }
+            if (sequence >= m_next + capacity)
+            {
+                m_next = sequence - capacity + 1;
+            }
+        }
+
+        // Packets not pushed yet keep their slots, so a slow output holds
+        // producers back instead of growing the ready list
+        auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(timeoutMs);
+        while (m_isRunning && sequence >= m_next + capacity - m_unsent)
+        {
+            if (!m_isEmitting && !m_ready.empty())
+            {
+                result = emit(lock, timeoutMs) && result;
+            }
+            else if (m_hasSpace.wait_until(lock, deadline) == std::cv_status::timeout)
+            {
+                break;
+            }
+        }
+        if (!m_isRunning || sequence >= m_next + capacity - m_unsent)
+        {
+            PIPELINE_TRACE(TIMEOUT, this, timeoutMs);
+            return false;
+        }
+
+        if (sequence < m_next || m_window[sequence & mask] != nullptr)
+        {
+            PIPELINE_TRACE(DROP, this, static_cast<uint32_t>(sequence)); // Skipped meanwhile, or a duplicate
+            return false;
+        }
+
+        if (m_buffered == 0)
+        {
+            m_gapSince = std::chrono::steady_clock::now();
+        }
+        m_window[sequence & mask] = std::move(packet);
+        m_buffered++;
+
+        if (sequence == m_next)
+        {
+            collectReady();
+        }
+        else if (m_policy == GapPolicy::SKIP && std::chrono::steady_clock::now() - m_gapSince >= m_gapTimeout)
+        {
+            skipGap();
+        }
+        scheduleGapCheck();
+        return emit(lock, timeoutMs) && result;
+    }
+
+    void Sequencer::collectReady() noexcept
+    {
+        const size_t mask = m_window.size() - 1;
+        bool moved = false;
+        while (m_window[m_next & mask] != nullptr)
+        {
+            m_ready.push_back(std::move(m_window[m_next & mask]));
+            m_next++;
+            m_buffered--;
+            m_unsent++;
+            moved = true;
+        }
+        if (moved)
+        {
+            // The packets left behind now wait for the next gap
+            m_gapSince = std::chrono::steady_clock::now();
+        }
+    }
+
+    void Sequencer::skipGap() noexcept
+    {
+        const size_t mask = m_window.size() - 1;
+        while (m_buffered > 0 && m_window[m_next & mask] == nullptr)
+        {
+            PIPELINE_TRACE(DROP, this, static_cast<uint32_t>(m_next));
+            m_next++;
+        }
+        collectReady();
+    }
+
+    bool Sequencer::emit(std::unique_lock<std::mutex>& lock, uint32_t timeoutMs) noexcept
+    {
+        if (m_isEmitting)
+        {
+            return true; // The emitting thread pushes the new packets after its current ones
+        }
+        m_isEmitting = true;
+        bool result = true;
+        while (!m_ready.empty())
+        {
+            m_sending.swap(m_ready);
+            lock.unlock();
+            for (auto& packet: m_sending)
+            {
+                result = m_output->pushPacket(std::move(packet), timeoutMs) && result;
+            }
+            const size_t sent = m_sending.size();
+            m_sending.clear();
+            lock.lock();
+            m_unsent -= sent;
+            m_hasSpace.notify_all();
+        }
+        m_isEmitting = false;
+        m_hasSpace.notify_all();
+        return result;
+    }
+
+    void Sequencer::scheduleGapCheck() noexcept
+    {
+        // Called under the lock, so that stop() finds the timer it must cancel
+        IExecutor* exec = executor();
+        if (m_policy != GapPolicy::SKIP || m_buffered == 0 || exec == nullptr || !m_isRunning)
+        {
+            return;
+        }
+        m_handoff.scheduleAt(*exec, *this, m_gapSince + m_gapTimeout);
+    }
+
+    void Sequencer::run() noexcept
+    {
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            if (m_isRunning && m_buffered > 0 && std::chrono::steady_clock::now() - m_gapSince >= m_gapTimeout)
+            {
+                skipGap();
+                emit(lock, m_lastTimeout);
+            }
+        }
+
+        // Give up the task, then wake up again when the next gap is due
+        m_handoff.finishAt(*executor(), *this, [this]() {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            if (!m_isRunning || m_buffered == 0)
+            {
+                return std::chrono::steady_clock::time_point::max();
+            }
+            return m_gapSince + m_gapTimeout;
+        });
+    }
+}
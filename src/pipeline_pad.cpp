@@ -1,49 +1,207 @@
 #include "pipeline/pipeline_pad.h"
 #include "pipeline/pipeline.h"
+#include "pipeline/pipeline_trace.h"
+
+#include <cstdint>
 
 namespace lexus2k::pipeline
 {
     bool IPad::pushPacket(std::shared_ptr<IPacket> packet, uint32_t timeout) noexcept
     {
-        std::unique_lock<std::mutex> lock(m_mutex);
-        if (m_padType != PadType::INPUT)
+        if (m_padType.load(std::memory_order_relaxed) != PadType::INPUT && !m_isBuffering)
         {
-            auto linkedPad = m_linkedPad;
-            lock.unlock();
+            // Routes are resolved by Pipeline::compile() and kept up to date by then()
+            if (auto route = currentRoute())
+            {
+                return route->queuePacket(std::move(packet), timeout);
+            }
+            auto linkedPad = m_linkedPad.load(std::memory_order_acquire);
             if (linkedPad != nullptr)
             {
-                return linkedPad->pushPacket(packet, timeout);
+                return linkedPad->pushPacket(std::move(packet), timeout);
             }
             return false; // No linked pad available
         }
-        lock.unlock();
-        return queuePacket(packet, timeout);
+        return queuePacket(std::move(packet), timeout);
     }
 
-    INode& IPad::then(IPad& pad) noexcept
+    bool IPad::dropExpired(const std::shared_ptr<IPacket>& packet) noexcept
     {
-        std::unique_lock<std::mutex> lock(m_mutex);
-        if (m_padType == PadType::UNDEFINED) {
-            m_padType = PadType::OUTPUT;
+        if (!packet || !packet->hasDeadline() || !packet->isExpired())
+        {
+            return false;
+        }
+        m_expired.fetch_add(1, std::memory_order_relaxed);
+        PIPELINE_TRACE(DROP, this, 1);
+        return true;
+    }
+
+    bool IPad::pushBatch(std::span<std::shared_ptr<IPacket>> packets, uint32_t timeout) noexcept
+    {
+        if (m_padType.load(std::memory_order_relaxed) != PadType::INPUT && !m_isBuffering)
+        {
+            return forwardBatch(packets, timeout);
+        }
+        return queueBatch(packets, timeout);
+    }
+
+    bool IPad::queueBatch(std::span<std::shared_ptr<IPacket>> packets, uint32_t timeout) noexcept
+    {
+        bool result = true;
+        for (auto& packet: packets)
+        {
+            result = queuePacket(std::move(packet), timeout) && result;
+        }
+        return result;
+    }
+
+    bool IPad::forwardBatch(std::span<std::shared_ptr<IPacket>> packets, uint32_t timeout) noexcept
+    {
+        if (auto route = currentRoute())
+        {
+            return route->queueBatch(packets, timeout);
+        }
+        auto linkedPad = m_linkedPad.load(std::memory_order_acquire);
+        if (linkedPad != nullptr && linkedPad != this)
+        {
+            return linkedPad->pushBatch(packets, timeout);
+        }
+        return false; // No linked pad available
+    }
+
+    // Synchronous pads forward the headroom query downstream. Past this depth,
+    // for instance around a cycle of synchronous pads, the headroom is unbounded.
+    static constexpr size_t MAX_HEADROOM_HOPS = 32;
+
+    size_t IPad::headroom(size_t hops) const noexcept
+    {
+        if (m_padType.load(std::memory_order_relaxed) != PadType::INPUT)
+        {
+            IPad* target = validRoute();
+            if (target == nullptr)
+            {
+                target = m_linkedPad.load(std::memory_order_acquire);
+            }
+            if (target == nullptr || target == this)
+            {
+                return 0; // Nothing would accept the packet
+            }
+            return hops >= MAX_HEADROOM_HOPS ? SIZE_MAX : target->headroom(hops + 1);
+        }
+
+        size_t capacity = queueCapacity();
+        if (capacity > 0)
+        {
+            size_t depth = queueDepth();
+            return capacity > depth ? capacity - depth : 0;
+        }
+        if (m_parentNode == nullptr || hops >= MAX_HEADROOM_HOPS)
+        {
+            return SIZE_MAX;
+        }
+        return m_parentNode->headroom(hops + 1);
+    }
+
+    // Chains of output pads longer than this are followed hop by hop
+    static constexpr size_t MAX_ROUTE_HOPS = 32;
+
+    IPad* IPad::validRoute() const noexcept
+    {
+        IPad* route = m_route.load(std::memory_order_acquire);
+        if (route == nullptr)
+        {
+            return nullptr;
         }
-        if (pad.m_padType == PadType::UNDEFINED) {
-            pad.m_padType = PadType::INPUT;
+        uint64_t generation = m_routeGeneration.load(std::memory_order_relaxed);
+        return generation == 0 || generation == linkGeneration() ? route : nullptr;
+    }
+
+    IPad* IPad::currentRoute() noexcept
+    {
+        if (IPad* route = validRoute())
+        {
+            return route;
+        }
+        if (m_route.load(std::memory_order_relaxed) == nullptr)
+        {
+            return nullptr; // Never resolved, cleared by then(), or leaving the scope
+        }
+
+        // A link further down changed: resolve the route again, unless this
+        // pad is being relinked right now
+        std::unique_lock<std::mutex> lock(m_mutex, std::try_to_lock);
+        if (!lock.owns_lock())
+        {
+            return nullptr;
+        }
+        return resolveRoute(MAX_ROUTE_HOPS);
+    }
+
+    IPad* IPad::resolveRoute(size_t maxHops) noexcept
+    {
+        std::atomic<uint64_t>& scope = linkScope();
+        uint64_t generation = scope.load(std::memory_order_acquire);
+        IPad* target = m_linkedPad.load(std::memory_order_acquire);
+        for (size_t hops = 0; target != nullptr && target->getType() == PadType::OUTPUT && !target->isBuffering(); hops++)
+        {
+            if (hops >= maxHops || &target->linkScope() != &scope)
+            {
+                target = nullptr;
+                break;
+            }
+            target = target->linkedPad();
         }
-        m_linkedPad = &pad;
+        setRoute(target, generation);
+        return target;
+    }
+
+    std::atomic<uint64_t>& IPad::linkScope() const noexcept
+    {
+        return m_parentNode != nullptr ? *m_parentNode->m_linkScope : INode::s_linkScope;
+    }
+
+    IPad* IPad::linkedPad() const noexcept
+    {
+        return m_linkedPad.load(std::memory_order_acquire);
+    }
+
+    INode& IPad::then(IPad& pad) noexcept
+    {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        auto undefined = PadType::UNDEFINED;
+        m_padType.compare_exchange_strong(undefined, PadType::OUTPUT, std::memory_order_relaxed);
+        undefined = PadType::UNDEFINED;
+        pad.m_padType.compare_exchange_strong(undefined, PadType::INPUT, std::memory_order_relaxed);
+        // Publishes the target pad, and its type, to lock-free readers
+        m_linkedPad.store(&pad, std::memory_order_release);
+        // Invalidates the routes of upstream pads that lead through this one.
+        // A route of the target resolved before its own last relink carries
+        // an older generation and is rejected.
+        std::atomic<uint64_t>& scope = linkScope();
+        uint64_t generation = scope.fetch_add(1, std::memory_order_acq_rel) + 1;
+        bool isInput = pad.m_padType.load(std::memory_order_relaxed) == PadType::INPUT;
+        bool isScoped = &pad.linkScope() == &scope;
+        setRoute(isInput || pad.m_isBuffering ? &pad : isScoped ? pad.validRoute() : nullptr, generation);
         return pad.node();
     }
 
     void IPad::then() noexcept
     {
         std::unique_lock<std::mutex> lock(m_mutex);
-        if (m_padType == PadType::UNDEFINED) {
-            m_padType = PadType::OUTPUT;
-        }
-        m_linkedPad = nullptr;
+        auto undefined = PadType::UNDEFINED;
+        m_padType.compare_exchange_strong(undefined, PadType::OUTPUT, std::memory_order_relaxed);
+        setRoute(nullptr, 0);
+        m_linkedPad.store(nullptr, std::memory_order_release);
+        linkScope().fetch_add(1, std::memory_order_acq_rel);
     }
 
     bool IPad::processPacket(std::shared_ptr<IPacket> packet, uint32_t timeout) noexcept
     {
-        return (node()).processPacket(packet, *this, timeout); // Pass reference instead of pointer
+        return (node()).processPacket(std::move(packet), *this, timeout); // Pass reference instead of pointer
+    }
+
+    bool IPad::processBatch(std::span<std::shared_ptr<IPacket>> packets, uint32_t timeout) noexcept
+    {
+        return (node()).processBatch(packets, *this, timeout);
     }
 }
\ No newline at end of file
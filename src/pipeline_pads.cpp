@@ -1,5 +1,9 @@
 #include "pipeline/pipeline_pads.h"
-#include <iostream>
+#include "pipeline/pipeline_node.h"
+#include "pipeline/pipeline_trace.h"
+#include <algorithm>
+#include <cassert>
+#include <chrono>
 
 namespace lexus2k::pipeline
 {
@@ -7,97 +11,835 @@ namespace lexus2k::pipeline
 
     bool SimplePad::queuePacket(std::shared_ptr<IPacket> packet, uint32_t timeout) noexcept
     {
-        return processPacket(packet, timeout);
+        if (packet && packet->hasDeadline())
+        {
+            auto now = IPacket::Clock::now();
+            if (packet->isExpired(now))
+            {
+                countExpired(1);
+                PIPELINE_TRACE(DROP, this, 1);
+                return false;
+            }
+            // The node may wait no longer than the packet has left, rounded up
+            auto left = std::chrono::ceil<std::chrono::milliseconds>(packet->deadline() - now).count();
+            timeout = static_cast<uint32_t>(std::min<int64_t>(timeout, left));
+        }
+        return processPacket(std::move(packet), timeout);
+    }
+
+    /// @brief Queued pad base
+
+    // Number of empty polls before the processing thread goes to sleep
+    static constexpr int QUEUE_SPIN_COUNT = 64;
+
+    // Number of batches an executor task drains before yielding the worker
+    static constexpr int QUEUE_TASK_ROUNDS = 16;
+
+    bool IQueuedPad::start() noexcept
+    {
+        if (m_isRunning.load(std::memory_order_relaxed))
+        {
+            return true; // Already running
+        }
+        if (m_thread.joinable())
+        {
+            m_thread.join(); // Stopped from its own context, see stop()
+        }
+
+        m_batch.reserve(m_batchSize);
+        IExecutor* executor = node().executor();
+        if (executor != nullptr && executor->isRunning())
+        {
+            // Producers that see the pad running must also see the executor
+            m_executor.store(executor, std::memory_order_release);
+            m_handoff.reset();
+            m_isRunning.store(true, std::memory_order_release);
+            return true;
+        }
+        m_executor.store(nullptr, std::memory_order_release);
+        m_isRunning.store(true, std::memory_order_release);
+
+        // Start the processing thread
+        m_thread = std::thread(&IQueuedPad::threadBody, this);
+        return true;
+    }
+
+    void IQueuedPad::stop() noexcept
+    {
+        if (!m_isRunning.load(std::memory_order_relaxed) && !m_thread.joinable())
+        {
+            return; // Not running
+        }
+
+        m_isRunning.store(false, std::memory_order_relaxed);
+        wakeProducers();
+
+        if (m_runner.load(std::memory_order_relaxed) == std::this_thread::get_id())
+        {
+            // Called by the node while it processes a packet of this pad: the
+            // processing loop ends on return, waiting here would deadlock
+            clear();
+            return;
+        }
+
+        if (m_thread.joinable())
+        {
+            m_wakeups.fetch_add(1, std::memory_order_release);
+            m_wakeups.notify_all();
+            m_thread.join();
+        }
+        else
+        {
+            // Wait for the task in flight, if any, to finish
+            m_handoff.wait();
+        }
+
+        // Release packets that were never processed
+        clear();
+    }
+
+    void IQueuedPad::notifyPacket() noexcept
+    {
+        IExecutor* executor = m_executor.load(std::memory_order_acquire);
+        if (executor != nullptr)
+        {
+            m_handoff.schedule(*executor, *this);
+            return;
+        }
+
+        // Pairs with the fence in the processing thread before it sleeps
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (m_isWaiting.load(std::memory_order_relaxed))
+        {
+            m_wakeups.fetch_add(1, std::memory_order_release);
+            m_wakeups.notify_one();
+        }
+    }
+
+    IPacket::Clock::time_point IQueuedPad::waitLimit(const std::shared_ptr<IPacket>& packet, uint32_t timeout) noexcept
+    {
+        auto limit = IPacket::Clock::now() + std::chrono::milliseconds(timeout);
+        return packet ? std::min(limit, packet->deadline()) : limit;
+    }
+
+    void IQueuedPad::dropExpiredBatch(uint32_t& timeout) noexcept
+    {
+        // The clock is read only if some packet carries a deadline
+        IPacket::Clock::time_point now{};
+        IPacket::Clock::time_point earliest = IPacket::Clock::time_point::max();
+        size_t kept = 0;
+        for (auto& packet: m_batch)
+        {
+            if (packet && packet->hasDeadline())
+            {
+                if (now == IPacket::Clock::time_point())
+                {
+                    now = IPacket::Clock::now();
+                }
+                if (packet->isExpired(now))
+                {
+                    continue;
+                }
+                earliest = std::min(earliest, packet->deadline());
+            }
+            if (&m_batch[kept] != &packet)
+            {
+                m_batch[kept] = std::move(packet);
+            }
+            kept++;
+        }
+        if (kept != m_batch.size())
+        {
+            countExpired(m_batch.size() - kept);
+            PIPELINE_TRACE(DROP, this, static_cast<uint32_t>(m_batch.size() - kept));
+            m_batch.resize(kept);
+        }
+        if (earliest != IPacket::Clock::time_point::max())
+        {
+            // Downstream hops may wait no longer than the packets have left, rounded up
+            auto left = std::chrono::ceil<std::chrono::milliseconds>(earliest - now).count();
+            timeout = static_cast<uint32_t>(std::min<int64_t>(timeout, left));
+        }
+    }
+
+    bool IQueuedPad::drainBatch() noexcept
+    {
+        uint32_t timeout = UINT32_MAX;
+        if (dequeue(m_batch, m_batchSize, timeout) == 0)
+        {
+            return false;
+        }
+        PIPELINE_TRACE(DEQUEUE, this, static_cast<uint32_t>(m_batch.size()));
+        dropExpiredBatch(timeout);
+        if (m_batch.empty())
+        {
+            return true;
+        }
+        m_inFlight.store(m_batch.size(), std::memory_order_relaxed);
+        if (m_batch.size() == 1)
+        {
+            processPacket(std::move(m_batch.front()), timeout);
+        }
+        else
+        {
+            processBatch(m_batch, timeout);
+        }
+        m_batch.clear();
+        m_inFlight.store(0, std::memory_order_relaxed);
+        return true;
+    }
+
+    void IQueuedPad::threadBody() noexcept
+    {
+        m_runner.store(std::this_thread::get_id(), std::memory_order_relaxed);
+        int idle = 0;
+        while (m_isRunning.load(std::memory_order_relaxed))
+        {
+            if (drainBatch())
+            {
+                idle = 0;
+                continue;
+            }
+            if (++idle < QUEUE_SPIN_COUNT)
+            {
+                std::this_thread::yield();
+                continue;
+            }
+
+            // The buffer stayed empty: sleep until a producer wakes us up
+            uint32_t ticket = m_wakeups.load(std::memory_order_acquire);
+            m_isWaiting.store(true, std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            if (empty() && m_isRunning.load(std::memory_order_relaxed))
+            {
+                PIPELINE_TRACE(WAIT, this, 0);
+                m_wakeups.wait(ticket, std::memory_order_acquire);
+                PIPELINE_TRACE(WAKEUP, this, 0);
+            }
+            m_isWaiting.store(false, std::memory_order_relaxed);
+            idle = 0;
+        }
+        m_runner.store(std::thread::id(), std::memory_order_relaxed);
+    }
+
+    void IQueuedPad::run() noexcept
+    {
+        m_runner.store(std::this_thread::get_id(), std::memory_order_relaxed);
+        for (int round = 0; round < QUEUE_TASK_ROUNDS; round++)
+        {
+            if (!m_isRunning.load(std::memory_order_relaxed) || !drainBatch())
+            {
+                break;
+            }
+        }
+        m_runner.store(std::thread::id(), std::memory_order_relaxed);
+
+        // Give up the pad, then make sure no packet slipped in meanwhile
+        m_handoff.finish(*m_executor.load(std::memory_order_relaxed), *this, [this]() {
+            return m_isRunning.load(std::memory_order_relaxed) && !empty();
+        });
     }
 
     /// @brief Queued pad
 
     bool QueuePad::queuePacket(std::shared_ptr<IPacket> packet, uint32_t timeout) noexcept
     {
-        std::cout << "QueuePad: Attempting to add packet to queue" << std::endl;
+        if (dropExpired(packet))
+        {
+            return false;
+        }
         std::unique_lock<std::mutex> lock(m_mutex);
 
-        // Wait for space in the queue or timeout
-        bool hasSpace = m_hasSpace.wait_for(lock, std::chrono::milliseconds(timeout), 
-            [this] { return !m_isRunning.load(std::memory_order_relaxed) || m_queue.size() < m_maxQueueSize; });
+        // Wait for space in the queue, until the timeout or the packet's deadline
+        bool hasSpace = m_hasSpace.wait_until(lock, waitLimit(packet, timeout),
+            [this] { return !isRunning() || m_queue.size() < m_maxQueueSize; });
 
-        std::cout << "QueuePad: Space in queue: " << hasSpace << std::endl;
-        std::cout << "QueuePad: Queue size: " << m_queue.size() << std::endl;
-        std::cout << "QueuePad: isRunning: " << m_isRunning.load(std::memory_order_relaxed) << std::endl;
-        if (!hasSpace || !m_isRunning.load(std::memory_order_relaxed))
+        if (!hasSpace || !isRunning())
         {
+            PIPELINE_TRACE(TIMEOUT, this, timeout);
             return false; // Timeout or pad is not running
         }
 
-        std::cout << "QueuePad: Adding packet to queue" << std::endl;
         // Add the packet to the queue
-        m_queue.emplace_back(timeout, packet);
+        m_queue.emplace_back(timeout, std::move(packet));
+        PIPELINE_TRACE(ENQUEUE, this, static_cast<uint32_t>(m_queue.size()));
         lock.unlock();
-        m_hasPackets.notify_one(); // Notify waiting threads
+        notifyPacket();
         return true;
     }
 
-    bool QueuePad::start() noexcept
+    bool QueuePad::queueBatch(std::span<std::shared_ptr<IPacket>> packets, uint32_t timeout) noexcept
     {
-        if (m_isRunning.load(std::memory_order_relaxed) || m_thread.joinable())
+        auto limit = IPacket::Clock::now() + std::chrono::milliseconds(timeout);
+        bool result = true;
+        size_t queued = 0;
+        while (queued < packets.size())
         {
-            return true; // Already running
-        }
+            // Wait no longer than the packet left with the earliest deadline has
+            auto waitUntil = limit;
+            for (size_t i = queued; i < packets.size(); i++)
+            {
+                if (packets[i])
+                {
+                    waitUntil = std::min(waitUntil, packets[i]->deadline());
+                }
+            }
 
-        m_isRunning.store(true, std::memory_order_relaxed);
+            std::unique_lock<std::mutex> lock(m_mutex);
+            bool hasSpace = m_hasSpace.wait_until(lock, waitUntil,
+                [this] { return !isRunning() || m_queue.size() < m_maxQueueSize; });
 
-        // Start the processing thread
-        m_thread = std::thread([this]() {
-            while (m_isRunning.load(std::memory_order_relaxed))
+            if (!isRunning() || (!hasSpace && waitUntil == limit))
+            {
+                PIPELINE_TRACE(TIMEOUT, this, timeout);
+                return false; // Timeout or pad is not running
+            }
+
+            if (!hasSpace)
             {
-                std::pair<uint32_t,std::shared_ptr<IPacket>> packet;
+                // The most urgent packet went stale while waiting: drop the
+                // stale packets, the fresh ones keep waiting
+                for (size_t i = queued; i < packets.size(); i++)
+                {
+                    if (dropExpired(packets[i]))
+                    {
+                        packets[i].reset();
+                        result = false;
+                    }
+                }
+                while (queued < packets.size() && !packets[queued])
+                {
+                    queued++;
+                }
+                continue;
+            }
 
+            // Add as many packets as fit while holding the lock
+            for (; queued < packets.size() && m_queue.size() < m_maxQueueSize; queued++)
+            {
+                if (dropExpired(packets[queued]))
+                {
+                    packets[queued].reset(); // Dropped, like a single stale packet
+                    result = false;
+                }
+                else if (packets[queued])
                 {
-                    std::unique_lock<std::mutex> lock(m_mutex);
+                    m_queue.emplace_back(timeout, std::move(packets[queued]));
+                }
+            }
+            PIPELINE_TRACE(ENQUEUE, this, static_cast<uint32_t>(m_queue.size()));
+            lock.unlock();
+            notifyPacket();
+        }
+        return result;
+    }
 
-                    std::cout << "QueuePad: Waiting for packets" << std::endl;
-                    // Wait for packets or stop signal
-                    m_hasPackets.wait(lock, [this] { return !m_isRunning || !m_queue.empty(); });
+    size_t QueuePad::dequeue(std::vector<std::shared_ptr<IPacket>>& batch, size_t maxCount, uint32_t& timeout) noexcept
+    {
+        size_t count = 0;
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
 
-                    if (!m_isRunning.load(std::memory_order_relaxed) && m_queue.empty())
-                    {
-                        break; // Exit if stopped and no packets remain
-                    }
+            // Retrieve up to a batch of packets in one go
+            for (; count < maxCount && !m_queue.empty(); count++)
+            {
+                timeout = std::min(timeout, m_queue.front().first);
+                batch.push_back(std::move(m_queue.front().second));
+                m_queue.pop_front();
+            }
+        }
+        if (count != 0)
+        {
+            m_hasSpace.notify_all(); // Wake up producers waiting for space
+        }
+        return count;
+    }
+
+    bool QueuePad::empty() const noexcept
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return m_queue.empty();
+    }
+
+    size_t QueuePad::queueDepth() const noexcept
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return m_queue.size();
+    }
+
+    void QueuePad::clear() noexcept
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_queue.clear();
+    }
+
+    void QueuePad::wakeProducers() noexcept
+    {
+        {
+            // Producers check the running flag under the lock
+            std::lock_guard<std::mutex> lock(m_mutex);
+        }
+        m_hasSpace.notify_all();
+    }
+
+    /// @brief Lock-free ring queued pads
 
-                    std::cout << "QueuePad: Retrieving packet from queue" << std::endl;
+    template <template <typename> class Ring>
+    bool BasicRingPad<Ring>::queuePacket(std::shared_ptr<IPacket> packet, uint32_t timeout) noexcept
+    {
+        if (!isRunning())
+        {
+            return false;
+        }
+        if (dropExpired(packet))
+        {
+            return false;
+        }
+        Item item{timeout, std::move(packet)};
+        if (!m_ring.tryPush(std::move(item)) && !waitPush(item, timeout))
+        {
+            return false;
+        }
+        PIPELINE_TRACE(ENQUEUE, this, static_cast<uint32_t>(m_ring.size()));
+        notifyPacket();
+        return true;
+    }
 
-                    // Retrieve the next packet
-                    packet = std::move(m_queue.front());
-                    m_queue.erase(m_queue.begin());
+    template <template <typename> class Ring>
+    bool BasicRingPad<Ring>::queueBatch(std::span<std::shared_ptr<IPacket>> packets, uint32_t timeout) noexcept
+    {
+        if (!isRunning())
+        {
+            return false;
+        }
+        bool result = true;
+        bool pending = false;
+        for (auto& packet: packets)
+        {
+            if (dropExpired(packet))
+            {
+                packet.reset(); // Dropped, like a single stale packet
+                result = false;
+                continue;
+            }
+            Item item{timeout, std::move(packet)};
+            if (m_ring.tryPush(std::move(item)))
+            {
+                pending = true;
+                continue;
+            }
+            if (pending)
+            {
+                // The consumer must run to free the slots we wait for
+                notifyPacket();
+                pending = false;
+            }
+            if (!waitPush(item, timeout))
+            {
+                packet = std::move(item.second); // Left to the caller, like the packets after it
+                result = false;
+                break;
+            }
+            pending = true;
+        }
+        if (pending)
+        {
+            PIPELINE_TRACE(ENQUEUE, this, static_cast<uint32_t>(m_ring.size()));
+            notifyPacket();
+        }
+        return result;
+    }
+
+    template <template <typename> class Ring>
+    bool BasicRingPad<Ring>::waitPush(Item& item, uint32_t timeout) noexcept
+    {
+        // The ring is full: back off until the consumer frees a slot
+        if (!pushWithBackoff(m_ring, item, waitLimit(item.second, timeout), [this] { return isRunning(); }))
+        {
+            PIPELINE_TRACE(TIMEOUT, this, timeout);
+            return false; // Timeout or pad is not running
+        }
+        return true;
+    }
+
+    template <template <typename> class Ring>
+    size_t BasicRingPad<Ring>::dequeue(std::vector<std::shared_ptr<IPacket>>& batch, size_t maxCount, uint32_t& timeout) noexcept
+    {
+        size_t count = 0;
+        Item item;
+        for (; count < maxCount && m_ring.tryPop(item); count++)
+        {
+            timeout = std::min(timeout, item.first);
+            batch.push_back(std::move(item.second));
+        }
+        return count;
+    }
+
+    template <template <typename> class Ring>
+    void BasicRingPad<Ring>::clear() noexcept
+    {
+        Item item;
+        while (m_ring.tryPop(item))
+        {
+        }
+    }
+
+    template class BasicRingPad<MpscRing>;
+    template class BasicRingPad<SpscRing>;
+
+    namespace
+    {
+        // Catches a second producer entering a single-producer pad while
+        // another push is in progress. Only debug builds pay for the check.
+        class ProducerCheck
+        {
+        public:
+            explicit ProducerCheck(std::atomic_bool& isPushing) noexcept : m_isPushing(isPushing)
+            {
+#ifndef NDEBUG
+                bool overlapping = m_isPushing.exchange(true, std::memory_order_acquire);
+                assert(!overlapping && "SpscQueuePad is fed by several threads at once");
+#endif
+            }
+
+            ~ProducerCheck()
+            {
+#ifndef NDEBUG
+                m_isPushing.store(false, std::memory_order_release);
+#endif
+            }
+
+        private:
+            [[maybe_unused]] std::atomic_bool& m_isPushing;
+        };
+    }
+
+    bool SpscQueuePad::queuePacket(std::shared_ptr<IPacket> packet, uint32_t timeout) noexcept
+    {
+        ProducerCheck check(m_isPushing);
+        return BasicRingPad::queuePacket(std::move(packet), timeout);
+    }
+
+    bool SpscQueuePad::queueBatch(std::span<std::shared_ptr<IPacket>> packets, uint32_t timeout) noexcept
+    {
+        ProducerCheck check(m_isPushing);
+        return BasicRingPad::queueBatch(packets, timeout);
+    }
+
+    /// @brief Priority queued pad
+
+    PriorityQueuePad::PriorityQueuePad(std::vector<PriorityLane> lanes, LaneScheduling scheduling, size_t batchSize)
+        : IQueuedPad(batchSize)
+        , m_scheduling(scheduling)
+    {
+        if (lanes.empty())
+        {
+            lanes.emplace_back();
+        }
+        for (auto& config: lanes)
+        {
+            m_lanes.push_back(std::make_unique<Lane>(config));
+        }
+        m_current = m_lanes.size() - 1;
+    }
+
+    static std::vector<PriorityLane> makeLanes(size_t lanes, size_t capacity)
+    {
+        std::vector<PriorityLane> result;
+        for (size_t i = 0; i < lanes; i++)
+        {
+            result.push_back(PriorityLane{capacity, static_cast<uint32_t>(i + 1)});
+        }
+        return result;
+    }
+
+    PriorityQueuePad::PriorityQueuePad(size_t lanes, size_t capacity, LaneScheduling scheduling, size_t batchSize)
+        : PriorityQueuePad(makeLanes(lanes, capacity), scheduling, batchSize)
+    {
+    }
+
+    bool PriorityQueuePad::pushPacket(std::shared_ptr<IPacket> packet, uint32_t timeout, uint8_t priority) noexcept
+    {
+        return pushToLane(*m_lanes[std::min<size_t>(priority, m_lanes.size() - 1)], std::move(packet), timeout);
+    }
+
+    void PriorityQueuePad::setClassifier(Classifier classifier)
+    {
+        m_classifier = std::move(classifier);
+    }
+
+    bool PriorityQueuePad::queuePacket(std::shared_ptr<IPacket> packet, uint32_t timeout) noexcept
+    {
+        size_t priority = packet && m_classifier ? m_classifier(*packet) : 0;
+        return pushToLane(*m_lanes[std::min(priority, m_lanes.size() - 1)], std::move(packet), timeout);
+    }
+
+    bool PriorityQueuePad::pushToLane(Lane& lane, std::shared_ptr<IPacket> packet, uint32_t timeout) noexcept
+    {
+        if (!isRunning() || dropExpired(packet))
+        {
+            return false;
+        }
+        Item item{timeout, std::move(packet)};
+        // The lane is full: back off until the consumer frees a slot
+        if (!lane.ring.tryPush(std::move(item)) &&
+            !pushWithBackoff(lane.ring, item, waitLimit(item.second, timeout), [this] { return isRunning(); }))
+        {
+            PIPELINE_TRACE(TIMEOUT, this, timeout);
+            return false; // Timeout or pad is not running
+        }
+        PIPELINE_TRACE(ENQUEUE, this, static_cast<uint32_t>(lane.ring.size()));
+        notifyPacket();
+        return true;
+    }
+
+    size_t PriorityQueuePad::dequeue(std::vector<std::shared_ptr<IPacket>>& batch, size_t maxCount, uint32_t& timeout) noexcept
+    {
+        size_t count = 0;
+        Item item;
+        if (m_scheduling == LaneScheduling::STRICT)
+        {
+            for (size_t i = m_lanes.size(); i-- > 0 && count < maxCount;)
+            {
+                for (; count < maxCount && m_lanes[i]->ring.tryPop(item); count++)
+                {
+                    timeout = std::min(timeout, item.first);
+                    batch.push_back(std::move(item.second));
                 }
+            }
+            return count;
+        }
 
-                // Process the packet
-                processPacket(packet.second, packet.first);
+        // Weighted round robin from the highest lane down. The turn of a
+        // lane ends when its credit is spent or it runs dry; the position
+        // is kept across calls so batch boundaries do not reset the weights.
+        size_t emptyLanes = 0;
+        while (count < maxCount && emptyLanes < m_lanes.size())
+        {
+            Lane& lane = *m_lanes[m_current];
+            if (m_credit == 0)
+            {
+                m_credit = lane.weight;
             }
-        });
+            if (lane.ring.tryPop(item))
+            {
+                timeout = std::min(timeout, item.first);
+                batch.push_back(std::move(item.second));
+                count++;
+                emptyLanes = 0;
+                if (--m_credit != 0)
+                {
+                    continue;
+                }
+            }
+            else
+            {
+                emptyLanes++;
+            }
+            m_current = m_current == 0 ? m_lanes.size() - 1 : m_current - 1;
+            m_credit = 0;
+        }
+        return count;
+    }
+
+    size_t PriorityQueuePad::laneDepth(uint8_t priority) const noexcept
+    {
+        return m_lanes[std::min<size_t>(priority, m_lanes.size() - 1)]->ring.size();
+    }
+
+    size_t PriorityQueuePad::queueDepth() const noexcept
+    {
+        size_t depth = 0;
+        for (auto& lane: m_lanes)
+        {
+            depth += lane->ring.size();
+        }
+        return depth;
+    }
+
+    size_t PriorityQueuePad::queueCapacity() const noexcept
+    {
+        size_t capacity = 0;
+        for (auto& lane: m_lanes)
+        {
+            capacity += lane->ring.capacity();
+        }
+        return capacity;
+    }
+
+    bool PriorityQueuePad::empty() const noexcept
+    {
+        return std::all_of(m_lanes.begin(), m_lanes.end(), [](const auto& lane) { return lane->ring.empty(); });
+    }
+
+    void PriorityQueuePad::clear() noexcept
+    {
+        Item item;
+        for (auto& lane: m_lanes)
+        {
+            while (lane->ring.tryPop(item))
+            {
+            }
+        }
+    }
+
+    /// @brief Batching output pad
+
+    BatchingPad::BatchingPad(size_t maxBatch, uint32_t latencyBudgetUs)
+        : IPad()
+        , m_maxBatch(maxBatch ? maxBatch : 1)
+        , m_budget(std::chrono::microseconds(latencyBudgetUs))
+        , m_interval(m_budget.count())
+    {
+        setBuffering();
+        m_batch.reserve(m_maxBatch);
+    }
+
+    bool BatchingPad::start() noexcept
+    {
+        if (m_isRunning.load(std::memory_order_relaxed))
+        {
+            return true; // Already running
+        }
+        m_executor = node().executor();
+        if (m_executor != nullptr && !m_executor->isRunning())
+        {
+            m_executor = nullptr;
+        }
+        m_handoff.reset();
+        m_isRunning.store(true, std::memory_order_release);
         return true;
     }
 
-    void QueuePad::stop() noexcept
+    void BatchingPad::stop() noexcept
     {
-        if (!m_thread.joinable())
+        if (!m_isRunning.exchange(false, std::memory_order_relaxed))
         {
             return; // Not running
         }
+        // Take back a flush task waiting for its time, or wait for it to finish
+        if (m_executor != nullptr)
+        {
+            m_handoff.cancel(*m_executor, *this);
+        }
+        m_handoff.wait();
+        flush();
+    }
+
+    bool BatchingPad::flush() noexcept
+    {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        return m_batch.empty() || deliver(lock);
+    }
+
+    bool BatchingPad::queuePacket(std::shared_ptr<IPacket> packet, uint32_t timeout) noexcept
+    {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        auto now = Clock::now();
+        if (m_lastArrival != Clock::time_point())
+        {
+            // Moving average over about the last eight arrivals
+            int64_t interval = std::chrono::duration_cast<std::chrono::nanoseconds>(now - m_lastArrival).count();
+            m_interval += (interval - m_interval) / 8;
+        }
+        m_lastArrival = now;
 
+        // As many packets as are expected to arrive within the budget
+        int64_t expected = m_budget.count() / std::max<int64_t>(m_interval, 1);
+        size_t target = static_cast<size_t>(std::clamp<int64_t>(expected, 1, static_cast<int64_t>(m_maxBatch)));
+        m_target.store(target, std::memory_order_relaxed);
+
+        bool isFirst = m_batch.empty();
+        if (isFirst)
         {
-            std::lock_guard<std::mutex> lock(m_mutex);
-            m_isRunning.store(false, std::memory_order_relaxed);
+            m_batchStart = now;
+            m_timeout = timeout;
+        }
+        else
+        {
+            m_timeout = std::min(m_timeout, timeout);
+        }
+        m_batch.push_back(std::move(packet));
+        if (m_batch.size() >= target || now - m_batchStart >= m_budget)
+        {
+            return deliver(lock);
+        }
+        lock.unlock();
+        if (isFirst)
+        {
+            scheduleFlush(now + m_budget);
         }
+        return true;
+    }
 
-        // Notify all waiting threads
-        m_hasPackets.notify_all();
-        m_hasSpace.notify_all();
+    bool BatchingPad::deliver(std::unique_lock<std::mutex>& lock) noexcept
+    {
+        // Close the batch and take a turn, so that batches leave in the order
+        // they were closed even though they are delivered without the lock
+        std::vector<std::shared_ptr<IPacket>> batch;
+        batch.swap(m_batch);
+        m_batch.swap(m_spare);
+        if (m_batch.capacity() == 0)
+        {
+            m_batch.reserve(m_maxBatch);
+        }
+        uint32_t timeout = m_timeout;
+        uint64_t turn = m_nextTurn++;
+        m_turnDone.wait(lock, [this, turn] { return m_turn == turn; });
+        lock.unlock();
 
-        // Join the thread
-        if (m_thread.joinable())
+        bool result = forwardBatch(batch, timeout);
+        if (!result)
         {
-            m_thread.join();
+            // Packets the linked pad did not take are left in the batch
+            size_t lost = static_cast<size_t>(std::count_if(batch.begin(), batch.end(),
+                [](const std::shared_ptr<IPacket>& packet) { return packet != nullptr; }));
+            if (lost != 0)
+            {
+                m_dropped.fetch_add(lost, std::memory_order_relaxed);
+                PIPELINE_TRACE(DROP, this, static_cast<uint32_t>(lost));
+            }
+        }
+        batch.clear();
+
+        lock.lock();
+        if (m_spare.capacity() == 0)
+        {
+            m_spare.swap(batch);
+        }
+        m_turn++;
+        lock.unlock();
+        m_turnDone.notify_all();
+        return result;
+    }
+
+    void BatchingPad::scheduleFlush(Clock::time_point due) noexcept
+    {
+        if (m_executor == nullptr || !m_isRunning.load(std::memory_order_relaxed))
+        {
+            return;
+        }
+        m_handoff.scheduleAt(*m_executor, *this, due);
+    }
+
+    void BatchingPad::run() noexcept
+    {
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            if (!m_batch.empty() && Clock::now() - m_batchStart >= m_budget)
+            {
+                deliver(lock);
+            }
         }
+
+        // Give up the task, then wake up again when the pending batch is due
+        m_handoff.finishAt(*m_executor, *this, [this]() {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            if (m_batch.empty() || !m_isRunning.load(std::memory_order_relaxed))
+            {
+                return Clock::time_point::max();
+            }
+            return m_batchStart + m_budget;
+        });
     }
-}
\ No newline at end of file
+}
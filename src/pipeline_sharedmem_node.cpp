@@ -195,7 +195,7 @@ bool SharedPublisherNode::waitForFreeSlot(uint32_t timeoutMs) noexcept
     return true;
 }
 
-bool SharedPublisherNode::serializeToSharedMem(std::shared_ptr<IPacket> packet, IPad& inputPad) noexcept
+bool SharedPublisherNode::serializeToSharedMem(const std::shared_ptr<IPacket>& packet, IPad& inputPad) noexcept
 {
     auto ptr = PTR(m_ptr);
     auto result = packet->serializeTo((uint8_t *)m_ptr + ptr->writeOffset, m_size - ptr->writeOffset);
@@ -338,7 +338,7 @@ bool SharedSubscriberNode::deserializeFromSharedMem() noexcept
         return false;
     }
     // TODO: Unlock the mutex before pushing the packet
-    return pad->pushPacket(packet, 0);
+    return pad->pushPacket(std::move(packet), 0);
 }
 
 bool SharedSubscriberNode::attachSharedMem() noexcept
@@ -0,0 +1,93 @@
+#include "pipeline/pipeline_trace.h"
+
+#include <array>
+#include <chrono>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace lexus2k::pipeline
+{
+    static_assert((Trace::RingSize & (Trace::RingSize - 1)) == 0, "Trace ring size must be a power of two");
+
+    namespace
+    {
+        struct TraceRing
+        {
+            explicit TraceRing(uint32_t index) : threadIndex(index) {}
+
+            uint32_t threadIndex; ///< Registration order of the owning thread.
+            std::atomic<uint64_t> head{0}; ///< Number of records ever written.
+            std::array<TraceRecord, Trace::RingSize> records{}; ///< Record storage.
+        };
+
+        std::mutex g_ringsMutex; ///< Protects the ring registry.
+        std::vector<std::shared_ptr<TraceRing>> g_rings; ///< Rings of all threads that traced.
+
+        TraceRing& localRing()
+        {
+            thread_local std::shared_ptr<TraceRing> ring = []() {
+                std::lock_guard<std::mutex> lock(g_ringsMutex);
+                auto newRing = std::make_shared<TraceRing>(static_cast<uint32_t>(g_rings.size()));
+                g_rings.push_back(newRing);
+                return newRing;
+            }();
+            return *ring;
+        }
+    }
+
+    void Trace::record(TraceEvent event, const void* object, uint32_t value) noexcept
+    {
+        auto& ring = localRing();
+        uint64_t position = ring.head.load(std::memory_order_relaxed);
+        auto& record = ring.records[position & (RingSize - 1)];
+        record.timestamp = std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count();
+        record.object = object;
+        record.value = value;
+        record.event = event;
+        ring.head.store(position + 1, std::memory_order_release);
+    }
+
+    void Trace::dump(std::ostream& out)
+    {
+        std::lock_guard<std::mutex> lock(g_ringsMutex);
+        for (auto& ring: g_rings)
+        {
+            uint64_t head = ring->head.load(std::memory_order_acquire);
+            uint64_t first = head > RingSize ? head - RingSize : 0;
+            for (uint64_t position = first; position < head; position++)
+            {
+                const auto& record = ring->records[position & (RingSize - 1)];
+                out << "[thread " << ring->threadIndex << "] "
+                    << record.timestamp << " "
+                    << eventName(record.event) << " "
+                    << record.object << " "
+                    << record.value << "\n";
+            }
+        }
+    }
+
+    void Trace::clear() noexcept
+    {
+        std::lock_guard<std::mutex> lock(g_ringsMutex);
+        for (auto& ring: g_rings)
+        {
+            ring->head.store(0, std::memory_order_release);
+        }
+    }
+
+    const char* Trace::eventName(TraceEvent event) noexcept
+    {
+        switch (event)
+        {
+            case TraceEvent::ENQUEUE: return "enqueue";
+            case TraceEvent::DEQUEUE: return "dequeue";
+            case TraceEvent::WAIT: return "wait";
+            case TraceEvent::WAKEUP: return "wakeup";
+            case TraceEvent::TIMEOUT: return "timeout";
+            case TraceEvent::DROP: return "drop";
+        }
+        return "unknown";
+    }
+}
@@ -1,6 +1,12 @@
 #include <gtest/gtest.h>
 #include "pipeline/pipeline.h"
+#include <atomic>
+#include <chrono>
 #include <memory>
+#include <mutex>
+#include <sstream>
+#include <thread>
+#include <vector>
 
 using namespace lexus2k::pipeline;
 
@@ -126,4 +132,941 @@ TEST_F(PipelineTest, TeeNodeTest) {
 
     EXPECT_TRUE(consumed1);
     EXPECT_TRUE(consumed2);
-}
\ No newline at end of file
+}
+
+TEST(SplitterTest, ParallelSplitterDoesNotWaitForSlowOutput)
+{
+    Pipeline pipeline(2);
+    std::atomic_bool release{false};
+    std::atomic<int> fastCount{0};
+    std::atomic<int> slowCount{0};
+
+    auto &tee = *pipeline.addNode<Splitter<2, SimplePad>>(SplitterMode::PARALLEL);
+
+    auto &slow = *pipeline.addNode([&](std::shared_ptr<IPacket> packet, IPad& pad) {
+        while (!release.load())
+        {
+            std::this_thread::yield();
+        }
+        slowCount++;
+        return true;
+    });
+    slow.addInput("input");
+
+    auto &fast = *pipeline.addNode([&](std::shared_ptr<IPacket> packet, IPad& pad) {
+        fastCount++;
+        return true;
+    });
+    fast.addInput("input");
+
+    pipeline.connect(tee["output_1"], slow["input"]);
+    pipeline.connect(tee["output_2"], fast["input"]);
+
+    ASSERT_TRUE(pipeline.start());
+
+    // The producer returns at once although the first output is stuck
+    for (int i = 0; i < 3; i++)
+    {
+        EXPECT_TRUE(tee["input"].pushPacket(std::make_shared<IPacket>(), 0));
+    }
+    for (int i = 0; i < 1000 && fastCount.load() < 3; i++)
+    {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    EXPECT_EQ(fastCount.load(), 3);
+    EXPECT_EQ(slowCount.load(), 0);
+
+    release = true;
+    for (int i = 0; i < 1000 && slowCount.load() < 3; i++)
+    {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    EXPECT_EQ(slowCount.load(), 3);
+    pipeline.stop();
+}
+
+class SequencePacket : public IPacket
+{
+public:
+    SequencePacket(size_t lane, size_t index) : lane(lane), index(index) {}
+    size_t lane;
+    size_t index;
+};
+
+TEST(MergerTest, MergesProducersInLaneOrder)
+{
+    constexpr size_t Producers = 4;
+    constexpr size_t PacketsPerProducer = 2000;
+    for (auto policy: {MergePolicy::ROUND_ROBIN, MergePolicy::PRIORITY, MergePolicy::TIMESTAMP})
+    {
+        Pipeline pipeline(2);
+        std::vector<size_t> next(Producers, 0);
+        std::atomic<size_t> received{0};
+        std::atomic<size_t> outOfOrder{0};
+
+        auto &merger = *pipeline.addNode<Merger<Producers>>(policy, 16);
+        auto &sink = *pipeline.addNode([&](std::shared_ptr<IPacket> packet, IPad& pad) {
+            auto sequenced = std::static_pointer_cast<SequencePacket>(packet);
+            if (sequenced->index != next[sequenced->lane]++)
+            {
+                outOfOrder++;
+            }
+            received.fetch_add(1, std::memory_order_release);
+            return true;
+        });
+        sink.addInput("input");
+        pipeline.connect(merger["output"], sink["input"]);
+        ASSERT_TRUE(pipeline.start());
+
+        std::vector<std::thread> producers;
+        for (size_t lane = 0; lane < Producers; lane++)
+        {
+            producers.emplace_back([&merger, lane]() {
+                auto& input = merger["input_" + std::to_string(lane + 1)];
+                for (size_t i = 0; i < PacketsPerProducer; i++)
+                {
+                    EXPECT_TRUE(input.pushPacket(std::make_shared<SequencePacket>(lane, i), 1000));
+                }
+            });
+        }
+        for (auto& producer: producers)
+        {
+            producer.join();
+        }
+        for (int i = 0; i < 2000 && received.load(std::memory_order_acquire) < Producers * PacketsPerProducer; i++)
+        {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+        EXPECT_EQ(received.load(std::memory_order_acquire), Producers * PacketsPerProducer);
+        EXPECT_EQ(outOfOrder.load(), 0u);
+        pipeline.stop();
+    }
+}
+
+TEST(MergerTest, TakesPacketsInPolicyOrder)
+{
+    // Packets pushed while the drain task is held by the gate packet, as (lane, index)
+    const std::vector<std::pair<size_t, size_t>> pushed = {{1, 0}, {0, 0}, {2, 1}, {1, 1}, {0, 1}, {1, 2}};
+    const std::vector<std::pair<MergePolicy, std::vector<std::pair<size_t, size_t>>>> expectations = {
+        {MergePolicy::ROUND_ROBIN, {{0, 0}, {1, 0}, {2, 1}, {0, 1}, {1, 1}, {1, 2}}},
+        {MergePolicy::PRIORITY, {{0, 0}, {0, 1}, {1, 0}, {1, 1}, {1, 2}, {2, 1}}},
+        {MergePolicy::TIMESTAMP, pushed},
+    };
+    for (auto& [policy, expected]: expectations)
+    {
+        Pipeline pipeline(2);
+        std::atomic_bool gateEntered{false};
+        std::atomic_bool gateOpen{false};
+        std::vector<std::pair<size_t, size_t>> order;
+        std::atomic<size_t> received{0};
+
+        auto &merger = *pipeline.addNode<Merger<3>>(policy, 16);
+        auto &sink = *pipeline.addNode([&](std::shared_ptr<IPacket> packet, IPad& pad) {
+            auto sequenced = std::static_pointer_cast<SequencePacket>(packet);
+            if (!gateEntered.exchange(true))
+            {
+                // Hold the drain task until all lanes are filled
+                while (!gateOpen.load())
+                {
+                    std::this_thread::yield();
+                }
+                return true;
+            }
+            order.emplace_back(sequenced->lane, sequenced->index);
+            received.fetch_add(1, std::memory_order_release);
+            return true;
+        });
+        sink.addInput("input");
+        pipeline.connect(merger["output"], sink["input"]);
+        ASSERT_TRUE(pipeline.start());
+
+        EXPECT_TRUE(merger["input_3"].pushPacket(std::make_shared<SequencePacket>(2, 0), 1000));
+        for (int i = 0; i < 2000 && !gateEntered.load(); i++)
+        {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+        ASSERT_TRUE(gateEntered.load());
+        for (auto& [lane, index]: pushed)
+        {
+            EXPECT_TRUE(merger["input_" + std::to_string(lane + 1)].pushPacket(std::make_shared<SequencePacket>(lane, index), 1000));
+        }
+        gateOpen = true;
+        for (int i = 0; i < 2000 && received.load(std::memory_order_acquire) < pushed.size(); i++)
+        {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+        pipeline.stop();
+        ASSERT_EQ(received.load(std::memory_order_acquire), pushed.size());
+        EXPECT_EQ(order, expected) << "policy " << static_cast<int>(policy);
+    }
+}
+
+class ReplicaNode : public INode
+{
+public:
+    explicit ReplicaNode(std::atomic_bool* gate = nullptr) : m_gate(gate)
+    {
+        addInput<RingQueuePad>("input");
+    }
+
+    std::atomic<size_t> count{0};
+    std::atomic<size_t> lanes{0}; ///< Bit mask of the SequencePacket lanes seen.
+
+protected:
+    bool processPacket(std::shared_ptr<IPacket> packet, IPad& inputPad, uint32_t timeoutMs) noexcept override
+    {
+        while (m_gate != nullptr && !m_gate->load())
+        {
+            std::this_thread::yield();
+        }
+        if (auto sequenced = std::dynamic_pointer_cast<SequencePacket>(packet))
+        {
+            lanes |= size_t(1) << sequenced->lane;
+        }
+        count++;
+        return true;
+    }
+
+private:
+    std::atomic_bool* m_gate;
+};
+
+static size_t waitForCount(const ReplicaGroup<ReplicaNode>& group, size_t expected)
+{
+    size_t total = 0;
+    for (int i = 0; i < 2000 && total < expected; i++)
+    {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        total = 0;
+        for (auto* replica: group.replicas)
+        {
+            total += replica->count.load();
+        }
+    }
+    return total;
+}
+
+TEST(DispatcherTest, RoundRobinAndKeyHash)
+{
+    Pipeline pipeline(2);
+    auto group = pipeline.addReplicated<ReplicaNode>(3);
+    ASSERT_EQ(group.replicas.size(), 3u);
+    ASSERT_TRUE(pipeline.start());
+
+    auto& input = (*group.dispatcher)["input"];
+    for (size_t i = 0; i < 300; i++)
+    {
+        EXPECT_TRUE(input.pushPacket(std::make_shared<IPacket>(), 100));
+    }
+    EXPECT_EQ(waitForCount(group, 300), 300u);
+    for (auto* replica: group.replicas)
+    {
+        EXPECT_EQ(replica->count.load(), 100u);
+    }
+    pipeline.stop();
+
+    // Packets with the same key always reach the same replica
+    group.dispatcher->setPolicy(DispatchPolicy::KEY_HASH, [](const IPacket& packet) {
+        return static_cast<const SequencePacket&>(packet).lane;
+    });
+    ASSERT_TRUE(pipeline.start());
+    for (size_t i = 0; i < 60; i++)
+    {
+        EXPECT_TRUE(input.pushPacket(std::make_shared<SequencePacket>(i % 6, i), 100));
+    }
+    EXPECT_EQ(waitForCount(group, 360), 360u);
+    for (size_t index = 0; index < group.replicas.size(); index++)
+    {
+        EXPECT_EQ(group.replicas[index]->lanes.load(), (size_t(1) << index) | (size_t(1) << (index + 3)));
+    }
+
+    // A missing packet has no key to hash
+    EXPECT_FALSE(input.pushPacket(nullptr, 100));
+    pipeline.stop();
+}
+
+TEST(DispatcherTest, RejectsPacketsWithoutOutputs)
+{
+    Dispatcher dispatcher(0);
+    EXPECT_FALSE(dispatcher["input"].pushPacket(std::make_shared<IPacket>(), 0));
+}
+
+TEST(DispatcherTest, LeastLoadedAvoidsBusyReplica)
+{
+    Pipeline pipeline(4);
+    std::atomic_bool open{true};
+    std::atomic_bool closed{false};
+    auto group = pipeline.addReplicated<ReplicaNode>(3, &open);
+    group.replicas.push_back(pipeline.addNode<ReplicaNode>(&closed));
+    auto& busy = *group.replicas.back();
+    group.dispatcher->addOutput("output_4").then(busy["input"]);
+    group.dispatcher->setPolicy(DispatchPolicy::LEAST_LOADED);
+    ASSERT_TRUE(pipeline.start());
+
+    auto& input = (*group.dispatcher)["input"];
+    for (size_t i = 0; i < 60; i++)
+    {
+        EXPECT_TRUE(input.pushPacket(std::make_shared<IPacket>(), 100));
+        std::this_thread::sleep_for(std::chrono::microseconds(100));
+    }
+    // The stuck replica holds one packet and buffers a few more at most
+    EXPECT_EQ(busy["input"].inFlight(), 1u);
+    EXPECT_LE(busy["input"].queueDepth(), 5u);
+    EXPECT_GE(waitForCount(group, 55), 55u);
+    closed = true;
+    EXPECT_EQ(waitForCount(group, 60), 60u);
+    pipeline.stop();
+}
+
+class JitterNode : public INode
+{
+public:
+    explicit JitterNode(Sequencer* sequencer) : m_sequencer(sequencer)
+    {
+        addInput<RingQueuePad>("input");
+        addOutput("output");
+    }
+
+    std::atomic<size_t> mismatches{0}; ///< Packets whose stamp differs from their index.
+
+protected:
+    bool processPacket(std::shared_ptr<IPacket> packet, IPad& inputPad, uint32_t timeoutMs) noexcept override
+    {
+        uint64_t sequence = 0;
+        if (!m_sequencer->sequenceOf(packet, sequence) || sequence != static_cast<SequencePacket&>(*packet).index)
+        {
+            mismatches.fetch_add(1, std::memory_order_relaxed);
+        }
+        std::this_thread::sleep_for(std::chrono::microseconds(100 * (sequence % 4)));
+        return (*this)["output"].pushPacket(std::move(packet), timeoutMs);
+    }
+
+private:
+    Sequencer* m_sequencer;
+};
+
+TEST(SequencerTest, RestoresOrderAfterReplicas)
+{
+    Pipeline pipeline(4);
+    std::vector<size_t> order;
+    std::atomic<size_t> received{0};
+
+    auto &sequencer = *pipeline.addNode<Sequencer>(16, 1000, GapPolicy::WAIT);
+    auto group = pipeline.addReplicated<JitterNode>(3, &sequencer);
+    auto &sink = *pipeline.addNode([&](std::shared_ptr<IPacket> packet, IPad& pad) {
+        // The output gets the packet without the stamp
+        uint64_t sequence = 0;
+        EXPECT_FALSE(sequencer.sequenceOf(packet, sequence));
+        order.push_back(std::static_pointer_cast<SequencePacket>(packet)->index);
+        received.fetch_add(1, std::memory_order_release);
+        return true;
+    });
+    sink.addInput("input");
+
+    pipeline.connect(sequencer["fanout"], (*group.dispatcher)["input"]);
+    for (auto* replica: group.replicas)
+    {
+        pipeline.connect((*replica)["output"], sequencer["fanin"]);
+    }
+    pipeline.connect(sequencer["output"], sink["input"]);
+    ASSERT_TRUE(pipeline.start());
+
+    for (size_t i = 0; i < 200; i++)
+    {
+        EXPECT_TRUE(sequencer["input"].pushPacket(std::make_shared<SequencePacket>(0, i), 1000));
+    }
+    for (int i = 0; i < 2000 && received.load(std::memory_order_acquire) < 200; i++)
+    {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    ASSERT_EQ(received.load(std::memory_order_acquire), 200u);
+    for (size_t i = 0; i < order.size(); i++)
+    {
+        EXPECT_EQ(order[i], i);
+    }
+    for (auto* replica: group.replicas)
+    {
+        EXPECT_EQ(replica->mismatches.load(), 0u);
+    }
+    pipeline.stop();
+}
+
+/**
+ * @brief Builds a sequencer whose `"fanout"` packets are kept aside, so a test
+ *        can send them back to `"fanin"` in any order.
+ */
+struct GapFixture
+{
+    GapFixture(uint32_t gapTimeoutMs)
+        : pipeline(1)
+        , sequencer(*pipeline.addNode<Sequencer>(4, gapTimeoutMs, GapPolicy::SKIP))
+    {
+        auto &parallel = *pipeline.addNode([this](std::shared_ptr<IPacket> packet, IPad& pad) {
+            stamped.push_back(std::move(packet));
+            return true;
+        });
+        parallel.addInput("input");
+        auto &sink = *pipeline.addNode([this](std::shared_ptr<IPacket> packet, IPad& pad) {
+            std::lock_guard<std::mutex> lock(mutex);
+            order.push_back(std::static_pointer_cast<SequencePacket>(packet)->index);
+            return true;
+        });
+        sink.addInput("input");
+        pipeline.connect(sequencer["fanout"], parallel["input"]);
+        pipeline.connect(sequencer["output"], sink["input"]);
+    }
+
+    bool start(size_t count)
+    {
+        if (!pipeline.start())
+        {
+            return false;
+        }
+        for (size_t i = 0; i < count; i++)
+        {
+            sequencer["input"].pushPacket(std::make_shared<SequencePacket>(0, i), 0);
+        }
+        return stamped.size() == count;
+    }
+
+    bool push(size_t index)
+    {
+        return sequencer["fanin"].pushPacket(stamped[index], 0);
+    }
+
+    std::vector<size_t> received()
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        return order;
+    }
+
+    Pipeline pipeline;
+    Sequencer& sequencer;
+    std::vector<std::shared_ptr<IPacket>> stamped;
+    std::mutex mutex;
+    std::vector<size_t> order;
+};
+
+TEST(SequencerTest, SkipsGaps)
+{
+    GapFixture fixture(1000);
+    ASSERT_TRUE(fixture.start(6));
+
+    EXPECT_TRUE(fixture.push(0));
+    EXPECT_TRUE(fixture.push(2));
+    EXPECT_TRUE(fixture.push(3));
+    EXPECT_EQ(fixture.received(), (std::vector<size_t>{0}));
+
+    // Sequence 5 does not fit in the window: packet 1 is given up
+    EXPECT_TRUE(fixture.push(5));
+    EXPECT_EQ(fixture.received(), (std::vector<size_t>{0, 2, 3}));
+    EXPECT_FALSE(fixture.push(1));
+
+    fixture.sequencer.flush();
+    EXPECT_EQ(fixture.received(), (std::vector<size_t>{0, 2, 3, 5}));
+
+    // Packets without the stamp of this sequencer are rejected
+    EXPECT_FALSE(fixture.sequencer["fanin"].pushPacket(std::make_shared<SequencePacket>(0, 6), 0));
+    fixture.pipeline.stop();
+}
+
+TEST(SequencerTest, SkipsGapsAfterTimeoutWithoutTraffic)
+{
+    GapFixture fixture(20);
+    ASSERT_TRUE(fixture.start(3));
+
+    EXPECT_TRUE(fixture.push(0));
+    EXPECT_TRUE(fixture.push(2));
+    EXPECT_EQ(fixture.received(), (std::vector<size_t>{0}));
+
+    // No packet arrives and nothing is flushed: the gap timer gives up on 1
+    for (int i = 0; i < 1000 && fixture.received().size() < 2; i++)
+    {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    EXPECT_EQ(fixture.received(), (std::vector<size_t>{0, 2}));
+    EXPECT_FALSE(fixture.push(1));
+    fixture.pipeline.stop();
+}
+
+class StartupSource : public INode
+{
+public:
+    StartupSource()
+    {
+        addOutput("output");
+    }
+
+protected:
+    bool start() noexcept override
+    {
+        // Emits while the pipeline is still starting
+        return (*this)["output"].pushPacket(std::make_shared<IPacket>(), 100);
+    }
+
+    bool processPacket(std::shared_ptr<IPacket> packet, IPad& inputPad, uint32_t timeoutMs) noexcept override
+    {
+        return false;
+    }
+};
+
+TEST_F(PipelineTest, CompileOrdersNodes)
+{
+    std::atomic<int> consumed{0};
+    auto &source = *pipeline->addNode<StartupSource>();
+    auto &sink = *pipeline->addNode([&consumed](std::shared_ptr<IPacket> packet, IPad& pad) {
+        consumed++;
+        return true;
+    });
+    sink.addInput<QueuePad>("input");
+    auto &middle = *pipeline->addNode([](std::shared_ptr<IPacket> packet, IPad& pad) {
+        return pad.node()["output"].pushPacket(std::move(packet), 100);
+    });
+    middle.addInput<QueuePad>("input");
+    middle.addOutput("output");
+
+    source["output"].then(middle["input"])["output"].then(sink["input"]);
+
+    ASSERT_TRUE(pipeline->compile());
+    EXPECT_EQ(pipeline->order(), (std::vector<INode*>{&source, &middle, &sink}));
+    EXPECT_TRUE(pipeline->danglingOutputs().empty());
+    EXPECT_FALSE(pipeline->hasCycles());
+
+    // Consumers start first, so the packet sent during startup is not lost
+    ASSERT_TRUE(pipeline->start());
+    for (int i = 0; i < 1000 && consumed.load() == 0; i++)
+    {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    EXPECT_EQ(consumed.load(), 1);
+    pipeline->stop();
+}
+
+TEST_F(PipelineTest, CompileReportsDanglingOutputsAndCycles)
+{
+    auto forward = [](std::shared_ptr<IPacket> packet, IPad& pad) {
+        return pad.node()["output"].pushPacket(std::move(packet), 0);
+    };
+    auto &first = *pipeline->addNode(forward);
+    first.addInput("input");
+    first.addOutput("output");
+    auto &second = *pipeline->addNode(forward);
+    second.addInput("input");
+    second.addOutput("output");
+    auto &unused = second.addOutput("unused");
+
+    first["output"].then(second["input"])["output"].then(first["input"]);
+
+    ASSERT_TRUE(pipeline->compile());
+    EXPECT_TRUE(pipeline->hasCycles());
+    EXPECT_EQ(pipeline->danglingOutputs(), (std::vector<const IPad*>{&unused}));
+    EXPECT_EQ(pipeline->order().size(), 2u);
+
+    pipeline->setStrict(true);
+    EXPECT_FALSE(pipeline->compile());
+    EXPECT_FALSE(pipeline->start());
+}
+
+TEST_F(PipelineTest, HeadroomPropagatesUpstream)
+{
+    std::atomic_bool release{false};
+    std::atomic<int> consumed{0};
+
+    auto &source = *pipeline->addNode<StartupSource>();
+    auto &middle = *pipeline->addNode([](std::shared_ptr<IPacket> packet, IPad& pad) {
+        return pad.node()["output"].pushPacket(std::move(packet), 0);
+    });
+    middle.addInput("input");
+    middle.addOutput("output");
+    auto &sink = *pipeline->addNode([&](std::shared_ptr<IPacket> packet, IPad& pad) {
+        while (!release.load())
+        {
+            std::this_thread::yield();
+        }
+        consumed++;
+        return true;
+    });
+    sink.addInput<QueuePad>("input", 4);
+
+    source["output"].then(middle["input"])["output"].then(sink["input"]);
+    ASSERT_TRUE(pipeline->start());
+
+    // The packet sent at startup is stuck in the sink, the queue is empty
+    for (int i = 0; i < 1000 && sink["input"].queueDepth() != 0; i++)
+    {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    EXPECT_EQ(source.headroom(), 4u);
+    EXPECT_EQ(middle["input"].headroom(), 4u);
+
+    while (source.canEmit())
+    {
+        EXPECT_TRUE(source["output"].pushPacket(std::make_shared<IPacket>(), 0));
+    }
+    EXPECT_EQ(sink["input"].queueDepth(), 4u);
+    EXPECT_EQ(middle["input"].headroom(), 0u);
+    EXPECT_FALSE(source["output"].pushPacket(std::make_shared<IPacket>(), 0));
+
+    release = true;
+    for (int i = 0; i < 1000 && consumed.load() < 5; i++)
+    {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    EXPECT_EQ(consumed.load(), 5);
+    EXPECT_TRUE(source.canEmit(4));
+
+    // An output without a link accepts nothing
+    source["output"].then();
+    EXPECT_FALSE(source.canEmit());
+    pipeline->stop();
+}
+
+TEST_F(PipelineTest, HeadroomSkipsDanglingOutputs)
+{
+    auto &source = *pipeline->addNode<StartupSource>();
+    source.addOutput("debug");
+    auto &sink = *pipeline->addNode([](std::shared_ptr<IPacket> packet, IPad& pad) {
+        return true;
+    });
+    sink.addInput<QueuePad>("input", 4);
+    source["output"].then(sink["input"]);
+
+    // The unlinked debug output does not hold the linked one back
+    EXPECT_EQ(source.headroom(), 4u);
+    EXPECT_TRUE(source.canEmit(4));
+    EXPECT_FALSE(source.canEmit(5));
+
+    source["output"].then();
+    EXPECT_FALSE(source.canEmit());
+}
+
+class BatchSink : public INode
+{
+public:
+    BatchSink()
+    {
+        addInput<QueuePad>("input", 256, 32);
+    }
+
+    size_t count()
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        return sequences.size();
+    }
+
+    std::mutex mutex;
+    std::vector<size_t> sequences;
+    size_t largestBatch = 0;
+
+protected:
+    bool processPacket(std::shared_ptr<IPacket> packet, IPad& inputPad, uint32_t timeoutMs) noexcept override
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        sequences.push_back(static_cast<SequencePacket&>(*packet).index);
+        largestBatch = std::max<size_t>(largestBatch, 1);
+        return true;
+    }
+
+    bool processBatch(std::span<std::shared_ptr<IPacket>> packets, IPad& inputPad, uint32_t timeoutMs) noexcept override
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        for (auto& packet: packets)
+        {
+            sequences.push_back(static_cast<SequencePacket&>(*packet).index);
+        }
+        largestBatch = std::max(largestBatch, packets.size());
+        return true;
+    }
+};
+
+TEST_F(PipelineTest, BatchingPadAdaptsToLoad)
+{
+    auto &source = *pipeline->addNode([](std::shared_ptr<IPacket> packet, IPad& pad) {
+        return false;
+    });
+    auto &output = source.addOutput<BatchingPad>("output", 16, 100000);
+    auto &sink = *pipeline->addNode<BatchSink>();
+    source["output"].then(sink["input"]);
+    ASSERT_TRUE(pipeline->start());
+
+    // A single packet at low load leaves well before the budget expires
+    EXPECT_EQ(output.batchTarget(), 1u);
+    EXPECT_TRUE(source["output"].pushPacket(std::make_shared<SequencePacket>(0, 0), 100));
+    for (int i = 0; i < 50 && sink.count() < 1; i++)
+    {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    EXPECT_EQ(sink.count(), 1u);
+
+    // A burst grows the batches, the budget flushes the last one
+    std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    for (size_t i = 1; i <= 200; i++)
+    {
+        EXPECT_TRUE(source["output"].pushPacket(std::make_shared<SequencePacket>(0, i), 100));
+    }
+    EXPECT_GT(output.batchTarget(), 1u);
+    for (int i = 0; i < 1000 && sink.count() < 201; i++)
+    {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    pipeline->stop();
+
+    ASSERT_EQ(sink.count(), 201u);
+    for (size_t i = 0; i < sink.sequences.size(); i++)
+    {
+        EXPECT_EQ(sink.sequences[i], i);
+    }
+    EXPECT_GT(sink.largestBatch, 1u);
+}
+
+TEST(BatchingPadTest, CountsPacketsNotTaken)
+{
+    ILambdaNode source([](std::shared_ptr<IPacket> packet, IPad& pad) {
+        return false;
+    });
+    auto &output = source.addOutput<BatchingPad>("output", 4, 1000000);
+    ILambdaNode sink([](std::shared_ptr<IPacket> packet, IPad& pad) {
+        return true;
+    });
+    sink.addInput<QueuePad>("input", 8);
+    output.then(sink["input"]);
+
+    // The sink is not started, so every batch is refused as a whole
+    for (size_t i = 0; i < 8; i++)
+    {
+        output.pushPacket(std::make_shared<SequencePacket>(0, i), 0);
+    }
+    output.flush();
+    EXPECT_EQ(output.droppedPackets(), 8u);
+}
+
+TEST(TraceTest, QueuePadRecordsEnqueueAndDequeue)
+{
+    Pipeline pipeline;
+    std::atomic<int> consumed{0};
+    auto &sink = *pipeline.addNode([&consumed](std::shared_ptr<IPacket> packet, IPad& pad) -> bool {
+        consumed++;
+        return true;
+    });
+    auto &input = sink.addInput<QueuePad>("input");
+
+    Trace::clear();
+    Trace::enable(true);
+    EXPECT_TRUE(pipeline.start());
+    for (int i = 0; i < 3; i++)
+    {
+        EXPECT_TRUE(input.pushPacket(std::make_shared<IPacket>(), 100));
+    }
+    for (int i = 0; i < 200 && consumed.load() < 3; i++)
+    {
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    }
+    pipeline.stop();
+    Trace::enable(false);
+    ASSERT_EQ(consumed.load(), 3);
+
+    std::ostringstream out;
+    Trace::dump(out);
+    std::ostringstream address;
+    address << static_cast<const void*>(&input);
+    size_t enqueued = 0;
+    size_t dequeued = 0;
+    std::istringstream lines(out.str());
+    for (std::string line; std::getline(lines, line);)
+    {
+        if (line.find(" " + address.str() + " ") == std::string::npos)
+        {
+            continue;
+        }
+        enqueued += line.find(" enqueue ") != std::string::npos;
+        dequeued += line.find(" dequeue ") != std::string::npos;
+    }
+#if defined(PIPELINE_ENABLE_TRACE)
+    EXPECT_EQ(enqueued, 3u);
+    EXPECT_GE(dequeued, 1u);
+#else
+    // The hooks compile to nothing without BUILD_WITH_TRACE
+    EXPECT_EQ(enqueued, 0u);
+    EXPECT_EQ(dequeued, 0u);
+#endif
+
+    Trace::clear();
+    std::ostringstream empty;
+    Trace::dump(empty);
+    EXPECT_TRUE(empty.str().empty());
+}
+
+TEST_F(PipelineTest, RelinkWhileRunning)
+{
+    std::atomic<int> consumed1{0};
+    std::atomic<int> consumed2{0};
+
+    auto &producer = *pipeline->addNode([](std::shared_ptr<IPacket> packet, IPad& pad) -> bool {
+        return pad.node()["output"].pushPacket(packet, 0);
+    });
+    producer.addInput("input");
+    producer.addOutput("output");
+
+    auto &consumer1 = *pipeline->addNode([&consumed1](std::shared_ptr<IPacket> packet, IPad& pad) -> bool {
+        consumed1++;
+        return true;
+    });
+    consumer1.addInput("input");
+
+    auto &consumer2 = *pipeline->addNode([&consumed2](std::shared_ptr<IPacket> packet, IPad& pad) -> bool {
+        consumed2++;
+        return true;
+    });
+    consumer2.addInput("input");
+
+    producer["output"].then(consumer1["input"]);
+    EXPECT_TRUE(pipeline->start());
+
+    const int packetCount = 10000;
+    std::thread sender([&]() {
+        for (int i = 0; i < packetCount; i++)
+        {
+            EXPECT_TRUE(producer["input"].pushPacket(std::make_shared<IPacket>(), 0));
+        }
+    });
+    for (int i = 0; i < 1000; i++)
+    {
+        producer["output"].then(i % 2 ? consumer1["input"] : consumer2["input"]);
+    }
+    sender.join();
+
+    EXPECT_EQ(consumed1.load() + consumed2.load(), packetCount);
+}
+
+TEST_F(PipelineTest, RelinkInsideRouteReachesNewTarget)
+{
+    int consumed1 = 0;
+    int consumed2 = 0;
+    auto &producer = *pipeline->addNode([](std::shared_ptr<IPacket> packet, IPad& pad) -> bool {
+        return pad.node()["output"].pushPacket(packet, 0);
+    });
+    producer.addInput("input");
+    producer.addOutput("output");
+
+    // An output pad of another node relays the packets
+    auto &relay = *pipeline->addNode([](std::shared_ptr<IPacket> packet, IPad& pad) -> bool {
+        return true;
+    });
+    relay.addOutput("relay");
+
+    auto &consumer1 = *pipeline->addNode([&consumed1](std::shared_ptr<IPacket> packet, IPad& pad) -> bool {
+        consumed1++;
+        return true;
+    });
+    consumer1.addInput("input");
+    auto &consumer2 = *pipeline->addNode([&consumed2](std::shared_ptr<IPacket> packet, IPad& pad) -> bool {
+        consumed2++;
+        return true;
+    });
+    consumer2.addInput("input");
+
+    producer["output"].then(relay["relay"]);
+    relay["relay"].then(consumer1["input"]);
+    EXPECT_TRUE(pipeline->start());
+    EXPECT_TRUE(producer["input"].pushPacket(std::make_shared<IPacket>(), 0));
+
+    // The producer's route led through the relay and must not stay on consumer1
+    relay["relay"].then(consumer2["input"]);
+    EXPECT_TRUE(producer["input"].pushPacket(std::make_shared<IPacket>(), 0));
+    EXPECT_TRUE(producer["input"].pushPacket(std::make_shared<IPacket>(), 0));
+    EXPECT_EQ(consumed1, 1);
+    EXPECT_EQ(consumed2, 2);
+}
+
+TEST_F(PipelineTest, RelinkOutsidePipelineReachesNewTarget)
+{
+    int consumed1 = 0;
+    int consumed2 = 0;
+    auto &producer = *pipeline->addNode([](std::shared_ptr<IPacket> packet, IPad& pad) -> bool {
+        return pad.node()["output"].pushPacket(packet, 0);
+    });
+    producer.addInput("input");
+    producer.addOutput("output");
+
+    // The relay is not part of the pipeline, so its relinks bump another generation
+    ILambdaNode relay([](std::shared_ptr<IPacket> packet, IPad& pad) -> bool {
+        return true;
+    });
+    relay.addOutput("relay");
+    ILambdaNode consumer1([&consumed1](std::shared_ptr<IPacket> packet, IPad& pad) -> bool {
+        consumed1++;
+        return true;
+    });
+    consumer1.addInput("input");
+    ILambdaNode consumer2([&consumed2](std::shared_ptr<IPacket> packet, IPad& pad) -> bool {
+        consumed2++;
+        return true;
+    });
+    consumer2.addInput("input");
+
+    producer["output"].then(relay["relay"]);
+    relay["relay"].then(consumer1["input"]);
+    EXPECT_TRUE(pipeline->start());
+    EXPECT_TRUE(producer["input"].pushPacket(std::make_shared<IPacket>(), 0));
+
+    relay["relay"].then(consumer2["input"]);
+    EXPECT_TRUE(producer["input"].pushPacket(std::make_shared<IPacket>(), 0));
+    EXPECT_EQ(consumed1, 1);
+    EXPECT_EQ(consumed2, 1);
+    pipeline->stop();
+}
+
+TEST(NodeTest, StandaloneSplitterReachesOutputs)
+{
+    int consumed1 = 0;
+    int consumed2 = 0;
+    Splitter<2, SimplePad> splitter;
+    ILambdaNode consumer1([&consumed1](std::shared_ptr<IPacket> packet, IPad& pad) -> bool {
+        consumed1++;
+        return true;
+    });
+    consumer1.addInput("input");
+    ILambdaNode consumer2([&consumed2](std::shared_ptr<IPacket> packet, IPad& pad) -> bool {
+        consumed2++;
+        return true;
+    });
+    consumer2.addInput("input");
+    splitter["output_1"].then(consumer1["input"]);
+    splitter["output_2"].then(consumer2["input"]);
+
+    // No pipeline: the output table comes from addOutput()
+    EXPECT_EQ(splitter.outputs().size(), 2u);
+    EXPECT_TRUE(splitter["input"].pushPacket(std::make_shared<IPacket>(), 0));
+    EXPECT_EQ(consumed1, 1);
+    EXPECT_EQ(consumed2, 1);
+}
+
+TEST_F(PipelineTest, PushThroughPadId)
+{
+    int consumed = 0;
+    auto &producer = *pipeline->addNode([](std::shared_ptr<IPacket> packet, IPad& pad) -> bool {
+        return true;
+    });
+    producer.addInput("input");
+    producer.addOutput("output");
+
+    auto &consumer = *pipeline->addNode([&consumed](std::shared_ptr<IPacket> packet, IPad& pad) -> bool {
+        consumed++;
+        return true;
+    });
+    consumer.addInput("input");
+    producer["output"].then(consumer["input"]);
+
+    PadId output = producer.padId("output");
+    PadId input = consumer.padId("input", PadType::INPUT);
+    EXPECT_TRUE(output);
+    EXPECT_EQ(&producer[output], &producer["output"]);
+    EXPECT_FALSE(producer.padId("output", PadType::INPUT));
+    EXPECT_FALSE(producer.padId("missing"));
+
+    EXPECT_TRUE(pipeline->start());
+    EXPECT_TRUE(producer.pushPacket(output, std::make_shared<IPacket>()));
+    EXPECT_TRUE(consumer.pushPacket(input, std::make_shared<IPacket>()));
+    EXPECT_FALSE(consumer.pushPacket(PadId(), std::make_shared<IPacket>()));
+    EXPECT_EQ(consumed, 2);
+}
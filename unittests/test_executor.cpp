@@ -0,0 +1,167 @@
+#include <gtest/gtest.h>
+#include "pipeline/pipeline.h"
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <thread>
+
+using namespace lexus2k::pipeline;
+
+template <typename Predicate>
+static bool waitFor(Predicate predicate, int timeoutMs = 2000)
+{
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(timeoutMs);
+    while (!predicate())
+    {
+        if (std::chrono::steady_clock::now() >= deadline)
+        {
+            return false;
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    return true;
+}
+
+static void checkSharedThreadPool(std::shared_ptr<Pipeline> pipeline)
+{
+    const int nodeCount = 40;
+    const int packetsPerNode = 50;
+
+    std::mutex mutex;
+    std::set<std::thread::id> threads;
+    std::atomic<int> consumed{0};
+    std::atomic<bool> serial{true};
+    std::vector<std::unique_ptr<std::atomic<int>>> inFlight;
+    std::vector<IPad*> inputs;
+    for (int i = 0; i < nodeCount; i++)
+    {
+        inFlight.push_back(std::make_unique<std::atomic<int>>(0));
+        auto* counter = inFlight.back().get();
+        auto &node = *pipeline->addNode([&, counter](std::shared_ptr<IPacket> packet, IPad& pad) -> bool {
+            if (counter->fetch_add(1) != 0)
+            {
+                serial.store(false);
+            }
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                threads.insert(std::this_thread::get_id());
+            }
+            consumed.fetch_add(1);
+            counter->fetch_sub(1);
+            return true;
+        });
+        inputs.push_back(&node.addInput<QueuePad>("input", 8));
+    }
+
+    EXPECT_TRUE(pipeline->start());
+
+    std::thread producer([&]() {
+        for (int n = 0; n < packetsPerNode; n++)
+        {
+            for (auto* input: inputs)
+            {
+                EXPECT_TRUE(input->pushPacket(std::make_shared<IPacket>(), 1000));
+            }
+        }
+    });
+    for (int n = 0; n < packetsPerNode; n++)
+    {
+        for (auto* input: inputs)
+        {
+            EXPECT_TRUE(input->pushPacket(std::make_shared<IPacket>(), 1000));
+        }
+    }
+    producer.join();
+
+    EXPECT_TRUE(waitFor([&]() { return consumed.load() == 2 * nodeCount * packetsPerNode; }));
+    EXPECT_TRUE(serial.load());
+    EXPECT_LE(threads.size(), pipeline->executor().threadCount());
+    pipeline->stop();
+}
+
+TEST(ExecutorTest, QueuedPadsShareThreadPool)
+{
+    checkSharedThreadPool(std::make_shared<Pipeline>(2));
+}
+
+TEST(ExecutorTest, QueuedPadsShareWorkStealingPool)
+{
+    checkSharedThreadPool(std::make_shared<Pipeline>(SchedulerType::WORK_STEALING, 2));
+}
+
+TEST(ExecutorTest, WorkStealingForwardsThroughChain)
+{
+    // Stages block on full downstream pads, so the pool is larger than the chain
+    const int stageCount = 4;
+    auto pipeline = std::make_shared<Pipeline>(SchedulerType::WORK_STEALING, stageCount + 1);
+    const int packetCount = 500;
+
+    std::atomic<int> consumed{0};
+    auto &sink = *pipeline->addNode([&](std::shared_ptr<IPacket> packet, IPad& pad) -> bool {
+        consumed.fetch_add(1);
+        return true;
+    });
+    IPad* next = &sink.addInput<QueuePad>("input", 16);
+    for (int i = 0; i < stageCount; i++)
+    {
+        auto &stage = *pipeline->addNode([](std::shared_ptr<IPacket> packet, IPad& pad) -> bool {
+            return pad.node()["output"].pushPacket(packet, 1000);
+        });
+        stage.addOutput("output").then(*next);
+        next = &stage.addInput<QueuePad>("input", 16);
+    }
+
+    EXPECT_TRUE(pipeline->start());
+    for (int n = 0; n < packetCount; n++)
+    {
+        EXPECT_TRUE(next->pushPacket(std::make_shared<IPacket>(), 1000));
+    }
+    EXPECT_TRUE(waitFor([&]() { return consumed.load() == packetCount; }));
+    pipeline->stop();
+}
+
+class CountingTask : public ITask
+{
+public:
+    std::atomic<int> runs{0};
+    std::atomic<int64_t> ranAt{0};
+
+    void run() noexcept override
+    {
+        ranAt = std::chrono::steady_clock::now().time_since_epoch().count();
+        runs++;
+    }
+};
+
+static void checkScheduleAt(SchedulerType type)
+{
+    auto executor = IExecutor::create(type, 2);
+    CountingTask task;
+    EXPECT_FALSE(executor->scheduleAt(task, std::chrono::steady_clock::now()));
+    ASSERT_TRUE(executor->start());
+
+    auto due = std::chrono::steady_clock::now() + std::chrono::milliseconds(20);
+    EXPECT_TRUE(executor->scheduleAt(task, due));
+    std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    EXPECT_EQ(task.runs.load(), 0);
+    EXPECT_TRUE(waitFor([&]() { return task.runs.load() == 1; }));
+    EXPECT_GE(task.ranAt.load(), due.time_since_epoch().count());
+
+    // A task that is not due yet can be taken back
+    CountingTask later;
+    EXPECT_TRUE(executor->scheduleAt(later, std::chrono::steady_clock::now() + std::chrono::hours(1)));
+    EXPECT_TRUE(executor->cancel(later));
+    EXPECT_FALSE(executor->cancel(later));
+
+    // Stopping discards tasks that are still waiting
+    EXPECT_TRUE(executor->scheduleAt(later, std::chrono::steady_clock::now() + std::chrono::hours(1)));
+    executor->stop();
+    EXPECT_EQ(later.runs.load(), 0);
+}
+
+TEST(ExecutorTest, ScheduleAtRunsTasksWhenDue)
+{
+    checkScheduleAt(SchedulerType::SHARED_QUEUE);
+    checkScheduleAt(SchedulerType::WORK_STEALING);
+}
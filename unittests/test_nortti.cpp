@@ -0,0 +1,78 @@
+#include <gtest/gtest.h>
+#include "pipeline/pipeline.h"
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <thread>
+#include <vector>
+
+using namespace lexus2k::pipeline;
+
+// Built with -fno-rtti, together with a copy of the library built the same way
+
+class IndexPacket : public Packet<IndexPacket>
+{
+public:
+    explicit IndexPacket(size_t index) : index(index) {}
+    size_t index;
+};
+
+TEST(NoRttiTest, SequencerRestoresOrder)
+{
+    Pipeline pipeline(4);
+    std::vector<size_t> order;
+    std::atomic<size_t> received{0};
+    std::atomic<size_t> unstamped{0};
+
+    auto &sequencer = *pipeline.addNode<Sequencer>(16, 1000, GapPolicy::WAIT);
+    auto &dispatcher = *pipeline.addNode<Dispatcher>(2);
+    auto replica = [&](std::shared_ptr<IPacket> packet, IPad& pad) {
+        uint64_t sequence = 0;
+        if (!sequencer.sequenceOf(packet, sequence))
+        {
+            unstamped.fetch_add(1);
+        }
+        std::this_thread::sleep_for(std::chrono::microseconds(100 * (sequence % 3)));
+        // Odd packets are replaced by a copy, which takes over the stamp
+        auto& indexed = static_cast<IndexPacket&>(*packet);
+        if (indexed.index % 2)
+        {
+            packet = sequencer.carryStamp(packet, std::make_shared<IndexPacket>(indexed.index));
+        }
+        return pad.node()["output"].pushPacket(std::move(packet), 1000);
+    };
+    auto &sink = *pipeline.addNode([&](std::shared_ptr<IPacket> packet, IPad& pad) {
+        order.push_back(static_cast<IndexPacket&>(*packet).index);
+        received.fetch_add(1, std::memory_order_release);
+        return true;
+    });
+    sink.addInput("input");
+
+    pipeline.connect(sequencer["fanout"], dispatcher["input"]);
+    for (size_t i = 1; i <= 2; i++)
+    {
+        auto &node = *pipeline.addNode(replica);
+        node.addInput<RingQueuePad>("input");
+        node.addOutput("output");
+        pipeline.connect(dispatcher["output_" + std::to_string(i)], node["input"]);
+        pipeline.connect(node["output"], sequencer["fanin"]);
+    }
+    pipeline.connect(sequencer["output"], sink["input"]);
+    ASSERT_TRUE(pipeline.start());
+
+    for (size_t i = 0; i < 50; i++)
+    {
+        EXPECT_TRUE(sequencer["input"].pushPacket(std::make_shared<IndexPacket>(i), 1000));
+    }
+    for (int i = 0; i < 2000 && received.load(std::memory_order_acquire) < 50; i++)
+    {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    ASSERT_EQ(received.load(std::memory_order_acquire), 50u);
+    EXPECT_EQ(unstamped.load(), 0u);
+    for (size_t i = 0; i < order.size(); i++)
+    {
+        EXPECT_EQ(order[i], i);
+    }
+    pipeline.stop();
+}
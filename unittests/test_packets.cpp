@@ -0,0 +1,138 @@
+#include <gtest/gtest.h>
+#include "pipeline/pipeline.h"
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <thread>
+#include <vector>
+
+using namespace lexus2k::pipeline;
+
+class PooledPacket : public IPacket
+{
+public:
+    explicit PooledPacket(int value = 0) : value(value) {}
+
+    int value;
+};
+
+TEST(PacketTest, PacketPoolRecyclesBlocks)
+{
+    PacketPool<PooledPacket>::resetStats();
+    {
+        std::vector<std::shared_ptr<PooledPacket>> packets;
+        for (int i = 0; i < 10; i++)
+        {
+            packets.push_back(PacketPool<PooledPacket>::make(i));
+        }
+        EXPECT_EQ(packets[3]->value, 3);
+        EXPECT_EQ(PacketPool<PooledPacket>::stats().live, 10u);
+    }
+    auto before = PacketPool<PooledPacket>::stats();
+    EXPECT_EQ(before.live, 0u);
+    EXPECT_GE(before.highWater, 10u);
+
+    // Released blocks are handed out again
+    for (int i = 0; i < 10; i++)
+    {
+        auto packet = PacketPool<PooledPacket>::make(i);
+    }
+    auto after = PacketPool<PooledPacket>::stats();
+    EXPECT_EQ(after.hits - before.hits, 10u);
+    EXPECT_EQ(after.misses, before.misses);
+}
+
+TEST(PacketTest, PacketPoolAcrossThreads)
+{
+    const int packetCount = 1000;
+    std::vector<std::shared_ptr<PooledPacket>> packets;
+    for (int i = 0; i < packetCount; i++)
+    {
+        packets.push_back(PacketPool<PooledPacket>::make(i));
+    }
+    // Release on another thread: the blocks overflow to the global list
+    std::thread consumer([&]() { packets.clear(); });
+    consumer.join();
+
+    auto before = PacketPool<PooledPacket>::stats();
+    for (int i = 0; i < packetCount; i++)
+    {
+        packets.push_back(PacketPool<PooledPacket>::make(i));
+    }
+    auto after = PacketPool<PooledPacket>::stats();
+    EXPECT_EQ(after.hits - before.hits, static_cast<uint64_t>(packetCount));
+}
+
+TEST(PacketTest, PacketPoolThroughPipeline)
+{
+    std::atomic<int> received{0};
+    std::atomic<int> sum{0};
+
+    Pipeline pipeline;
+    auto& node = *pipeline.addNode([&](std::shared_ptr<IPacket> packet, IPad& pad) {
+        sum += static_cast<PooledPacket&>(*packet).value;
+        received++;
+        return true;
+    });
+    node.addInput<QueuePad>("input");
+    EXPECT_TRUE(pipeline.start());
+
+    // Warm the pool, then push: the blocks come back once the queue drained
+    for (int i = 0; i < 8; i++)
+    {
+        PacketPool<PooledPacket>::make(i);
+    }
+    auto before = PacketPool<PooledPacket>::stats();
+    for (int i = 1; i <= 4; i++)
+    {
+        EXPECT_TRUE(node.pushPacket("input", PacketPool<PooledPacket>::make(i), 100));
+    }
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(2);
+    while (received < 4 && std::chrono::steady_clock::now() < deadline)
+    {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    pipeline.stop();
+
+    EXPECT_EQ(sum.load(), 10);
+    auto after = PacketPool<PooledPacket>::stats();
+    EXPECT_EQ(after.misses, before.misses);
+    EXPECT_EQ(after.live, before.live);
+}
+
+class TaggedPacket : public Packet<TaggedPacket>
+{
+};
+
+class SpecialPacket : public Packet<SpecialPacket, TaggedPacket>
+{
+};
+
+class UntaggedPacket : public IPacket
+{
+};
+
+TEST(PacketTest, PacketCastUsesTypeTags)
+{
+    std::shared_ptr<IPacket> special = std::make_shared<SpecialPacket>();
+    std::shared_ptr<IPacket> tagged = std::make_shared<TaggedPacket>();
+
+    EXPECT_EQ(special->packetType(), SpecialPacket::staticPacketType());
+    EXPECT_TRUE(isPacketOf<SpecialPacket>(*special));
+    EXPECT_TRUE(isPacketOf<TaggedPacket>(*special));
+    EXPECT_FALSE(isPacketOf<SpecialPacket>(*tagged));
+
+    EXPECT_TRUE(packet_cast<TaggedPacket>(special));
+    EXPECT_FALSE(packet_cast<SpecialPacket>(tagged));
+    EXPECT_FALSE(packet_cast<TaggedPacket>(std::shared_ptr<IPacket>(std::make_shared<UntaggedPacket>())));
+
+    // A failed cast leaves the packet to the caller
+    auto cast = packet_cast<SpecialPacket>(std::move(tagged));
+    EXPECT_FALSE(cast);
+    EXPECT_TRUE(tagged);
+
+    // Copies carry the tag of their own type
+    SpecialPacket original;
+    TaggedPacket sliced(original);
+    EXPECT_EQ(sliced.packetType(), TaggedPacket::staticPacketType());
+}
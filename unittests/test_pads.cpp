@@ -0,0 +1,463 @@
+#include <gtest/gtest.h>
+#include "pipeline/pipeline.h"
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+using namespace lexus2k::pipeline;
+
+class PadTest : public ::testing::Test
+{
+protected:
+    std::shared_ptr<Pipeline> pipeline;
+
+    void SetUp() override
+    {
+        pipeline = std::make_shared<Pipeline>();
+    }
+
+    void TearDown() override
+    {
+        pipeline.reset();
+    }
+
+    template <typename Predicate>
+    static bool waitFor(Predicate predicate, int timeoutMs = 2000)
+    {
+        auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(timeoutMs);
+        while (!predicate())
+        {
+            if (std::chrono::steady_clock::now() >= deadline)
+            {
+                return false;
+            }
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+        return true;
+    }
+};
+
+TEST_F(PadTest, RingQueuePadMultipleProducers)
+{
+    std::atomic<uint32_t> consumed{0};
+    auto &consumer = *pipeline->addNode([&consumed](std::shared_ptr<IPacket> packet, IPad& pad) -> bool {
+        consumed.fetch_add(1, std::memory_order_relaxed);
+        return true;
+    });
+    auto &input = consumer.addInput<RingQueuePad>("input", 16);
+
+    EXPECT_TRUE(pipeline->start());
+
+    const uint32_t producerCount = 4;
+    const uint32_t packetsPerProducer = 10000;
+    std::atomic<uint32_t> rejected{0};
+    std::vector<std::thread> producers;
+    for (uint32_t i = 0; i < producerCount; i++)
+    {
+        producers.emplace_back([&input, &rejected]() {
+            for (uint32_t n = 0; n < packetsPerProducer; n++)
+            {
+                if (!input.pushPacket(std::make_shared<IPacket>(), 1000))
+                {
+                    rejected.fetch_add(1, std::memory_order_relaxed);
+                }
+            }
+        });
+    }
+    for (auto& producer: producers)
+    {
+        producer.join();
+    }
+
+    EXPECT_EQ(rejected.load(), 0u);
+    EXPECT_TRUE(waitFor([&]() { return consumed.load() == producerCount * packetsPerProducer; }));
+}
+
+TEST_F(PadTest, RingQueuePadRejectsWhenStopped)
+{
+    auto &consumer = *pipeline->addNode([](std::shared_ptr<IPacket> packet, IPad& pad) -> bool {
+        return true;
+    });
+    auto &input = consumer.addInput<RingQueuePad>("input");
+
+    EXPECT_FALSE(input.pushPacket(std::make_shared<IPacket>(), 0));
+    EXPECT_TRUE(pipeline->start());
+    EXPECT_TRUE(input.pushPacket(std::make_shared<IPacket>(), 0));
+    pipeline->stop();
+    EXPECT_FALSE(input.pushPacket(std::make_shared<IPacket>(), 0));
+}
+
+TEST_F(PadTest, QueuePadStopsFromItsOwnTask)
+{
+    std::atomic<int> consumed{0};
+    auto stopOnFirst = [&consumed](std::shared_ptr<IPacket> packet, IPad& pad) -> bool {
+        if (consumed.fetch_add(1) == 0)
+        {
+            pad.stop();
+        }
+        return true;
+    };
+
+    // On the pipeline's executor
+    auto &consumer = *pipeline->addNode(stopOnFirst);
+    auto &input = consumer.addInput<QueuePad>("input", 8);
+    EXPECT_TRUE(pipeline->start());
+    EXPECT_TRUE(input.pushPacket(std::make_shared<IPacket>(), 0));
+    EXPECT_TRUE(waitFor([&]() { return !input.pushPacket(std::make_shared<IPacket>(), 0); }));
+    pipeline->stop();
+    EXPECT_EQ(consumed.load(), 1);
+
+    // On a dedicated thread, which is joined by the next start
+    consumed = 0;
+    ILambdaNode standalone(stopOnFirst);
+    auto &threaded = standalone.addInput<QueuePad>("input", 8);
+    EXPECT_TRUE(threaded.start());
+    EXPECT_TRUE(threaded.pushPacket(std::make_shared<IPacket>(), 0));
+    EXPECT_TRUE(waitFor([&]() { return !threaded.pushPacket(std::make_shared<IPacket>(), 0); }));
+    EXPECT_TRUE(threaded.start());
+    EXPECT_TRUE(threaded.pushPacket(std::make_shared<IPacket>(), 0));
+    EXPECT_TRUE(waitFor([&]() { return consumed.load() == 2; }));
+    threaded.stop();
+}
+
+TEST_F(PadTest, SpscQueuePadPreservesOrder)
+{
+    class SequencePacket : public IPacket {
+    public:
+        explicit SequencePacket(uint32_t value) : value(value) {}
+        uint32_t value;
+    };
+
+    std::atomic<uint32_t> consumed{0};
+    std::atomic<bool> ordered{true};
+    auto &producer = *pipeline->addNode([](std::shared_ptr<IPacket> packet, IPad& pad) -> bool {
+        return pad.node()["output"].pushPacket(packet, 1000);
+    });
+    producer.addInput("input");
+    producer.addOutput("output");
+
+    auto &consumer = *pipeline->addNode([&consumed, &ordered](std::shared_ptr<IPacket> packet, IPad& pad) -> bool {
+        auto sequence = std::static_pointer_cast<SequencePacket>(packet);
+        if (sequence->value != consumed.load(std::memory_order_relaxed))
+        {
+            ordered.store(false);
+        }
+        consumed.fetch_add(1, std::memory_order_relaxed);
+        return true;
+    });
+    consumer.addInput<SpscQueuePad>("input", 8);
+
+    pipeline->connect(producer["output"], consumer["input"]);
+    EXPECT_TRUE(pipeline->start());
+
+    const uint32_t packetCount = 20000;
+    for (uint32_t i = 0; i < packetCount; i++)
+    {
+        EXPECT_TRUE(producer["input"].pushPacket(std::make_shared<SequencePacket>(i), 0));
+    }
+
+    EXPECT_TRUE(waitFor([&]() { return consumed.load() == packetCount; }));
+    EXPECT_TRUE(ordered.load());
+}
+
+TEST_F(PadTest, SpscQueuePadRejectsSecondProducer)
+{
+    auto &producer1 = *pipeline->addNode([](std::shared_ptr<IPacket> packet, IPad& pad) -> bool {
+        return true;
+    });
+    producer1.addOutput("output");
+    auto &producer2 = *pipeline->addNode([](std::shared_ptr<IPacket> packet, IPad& pad) -> bool {
+        return true;
+    });
+    producer2.addOutput("output");
+    auto &consumer = *pipeline->addNode([](std::shared_ptr<IPacket> packet, IPad& pad) -> bool {
+        return true;
+    });
+    consumer.addInput<SpscQueuePad>("input");
+
+    pipeline->connect(producer1["output"], consumer["input"]);
+    pipeline->connect(producer2["output"], consumer["input"]);
+
+    EXPECT_FALSE(pipeline->start());
+}
+
+TEST_F(PadTest, QueuePadDrainsBatches)
+{
+    class BatchNode : public INode {
+    public:
+        std::atomic<uint32_t> processed{0};
+        std::atomic<size_t> maxBatch{0};
+        std::atomic<bool> gate{false};
+        std::atomic<bool> holding{false};
+
+    protected:
+        bool processPacket(std::shared_ptr<IPacket> packet, IPad& inputPad, uint32_t timeoutMs) noexcept override
+        {
+            // Hold the first packet until the queue has filled up
+            holding.store(true);
+            while (!gate.load())
+            {
+                std::this_thread::yield();
+            }
+            processed.fetch_add(1);
+            return true;
+        }
+
+        bool processBatch(std::span<std::shared_ptr<IPacket>> packets, IPad& inputPad, uint32_t timeoutMs) noexcept override
+        {
+            maxBatch.store(std::max(maxBatch.load(), packets.size()));
+            processed.fetch_add(static_cast<uint32_t>(packets.size()));
+            return true;
+        }
+    };
+
+    auto &node = *pipeline->addNode<BatchNode>();
+    auto &input = node.addInput<QueuePad>("input", 64, 16);
+
+    EXPECT_TRUE(pipeline->start());
+
+    EXPECT_TRUE(input.pushPacket(std::make_shared<IPacket>(), 100));
+    EXPECT_TRUE(waitFor([&]() { return node.holding.load(); }));
+    for (int i = 0; i < 10; i++)
+    {
+        EXPECT_TRUE(input.pushPacket(std::make_shared<IPacket>(), 100));
+    }
+    node.gate.store(true);
+
+    EXPECT_TRUE(waitFor([&]() { return node.processed.load() == 11; }));
+    EXPECT_EQ(node.maxBatch.load(), 10u);
+}
+
+TEST_F(PadTest, QueuedPadsDropExpiredPackets)
+{
+    class GateNode : public INode {
+    public:
+        std::atomic<uint32_t> processed{0};
+        std::atomic<uint32_t> lastTimeout{0};
+        std::atomic<bool> gate{false};
+        std::atomic<bool> holding{false};
+
+    protected:
+        bool processPacket(std::shared_ptr<IPacket> packet, IPad& inputPad, uint32_t timeoutMs) noexcept override
+        {
+            holding.store(true);
+            while (!gate.load())
+            {
+                std::this_thread::yield();
+            }
+            lastTimeout.store(timeoutMs);
+            processed.fetch_add(1);
+            return true;
+        }
+    };
+
+    auto &node = *pipeline->addNode<GateNode>();
+    auto &input = node.addInput<QueuePad>("input", 64);
+
+    EXPECT_TRUE(pipeline->start());
+
+    EXPECT_TRUE(input.pushPacket(std::make_shared<IPacket>(), 100));
+    EXPECT_TRUE(waitFor([&]() { return node.holding.load(); }));
+
+    // Stale on arrival: rejected before it is queued
+    auto stale = std::make_shared<IPacket>();
+    stale->setDeadline(IPacket::Clock::now() - std::chrono::milliseconds(1));
+    EXPECT_FALSE(input.pushPacket(stale, 100));
+
+    // Expire while waiting behind the held packet
+    for (int i = 0; i < 5; i++)
+    {
+        auto packet = std::make_shared<IPacket>();
+        packet->setDeadline(std::chrono::milliseconds(10));
+        EXPECT_TRUE(input.pushPacket(packet, 100));
+        EXPECT_TRUE(input.pushPacket(std::make_shared<IPacket>(), 100));
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    node.gate.store(true);
+
+    EXPECT_TRUE(waitFor([&]() { return node.processed.load() == 6; }));
+    EXPECT_EQ(input.expiredPackets(), 6u);
+
+    // The timeout handed on is capped by the time left
+    auto fresh = std::make_shared<IPacket>();
+    fresh->setDeadline(std::chrono::milliseconds(500));
+    EXPECT_TRUE(input.pushPacket(fresh, 10000));
+    EXPECT_TRUE(waitFor([&]() { return node.processed.load() == 7; }));
+    EXPECT_LE(node.lastTimeout.load(), 500u);
+    EXPECT_GT(node.lastTimeout.load(), 0u);
+}
+
+TEST_F(PadTest, QueuePadBatchWaitEndsAtDeadline)
+{
+    class GateNode : public INode {
+    public:
+        std::atomic<uint32_t> processed{0};
+        std::atomic<bool> gate{false};
+        std::atomic<bool> holding{false};
+
+    protected:
+        bool processPacket(std::shared_ptr<IPacket> packet, IPad& inputPad, uint32_t timeoutMs) noexcept override
+        {
+            holding.store(true);
+            while (!gate.load())
+            {
+                std::this_thread::yield();
+            }
+            processed.fetch_add(1);
+            return true;
+        }
+    };
+
+    auto &node = *pipeline->addNode<GateNode>();
+    auto &input = node.addInput<QueuePad>("input", 1);
+    EXPECT_TRUE(pipeline->start());
+
+    // One packet is held by the node, one fills the queue
+    EXPECT_TRUE(input.pushPacket(std::make_shared<IPacket>(), 100));
+    EXPECT_TRUE(waitFor([&]() { return node.holding.load(); }));
+    EXPECT_TRUE(input.pushPacket(std::make_shared<IPacket>(), 100));
+
+    // The long timeout does not keep the batch waiting past its deadline
+    auto packet = std::make_shared<IPacket>();
+    packet->setDeadline(std::chrono::milliseconds(20));
+    std::vector<std::shared_ptr<IPacket>> batch{packet};
+    auto start = std::chrono::steady_clock::now();
+    EXPECT_FALSE(input.pushBatch(batch, 10000));
+    EXPECT_LT(std::chrono::steady_clock::now() - start, std::chrono::seconds(5));
+    EXPECT_EQ(batch[0], nullptr);
+    EXPECT_EQ(input.expiredPackets(), 1u);
+
+    node.gate.store(true);
+    EXPECT_TRUE(waitFor([&]() { return node.processed.load() == 2; }));
+}
+
+TEST_F(PadTest, InputPadsRejectStalePacketsAlike)
+{
+    class CountNode : public INode {
+    public:
+        std::atomic<uint32_t> processed{0};
+        std::atomic<uint32_t> lastTimeout{0};
+
+    protected:
+        bool processPacket(std::shared_ptr<IPacket> packet, IPad& inputPad, uint32_t timeoutMs) noexcept override
+        {
+            lastTimeout.store(timeoutMs);
+            processed.fetch_add(1);
+            return true;
+        }
+    };
+
+    auto stalePacket = []() {
+        auto packet = std::make_shared<IPacket>();
+        packet->setDeadline(IPacket::Clock::now() - std::chrono::milliseconds(1));
+        return packet;
+    };
+
+    // A synchronous pad checks the deadline too and caps the timeout
+    auto &direct = *pipeline->addNode<CountNode>();
+    auto &simple = direct.addInput("input");
+    auto &queued = *pipeline->addNode<CountNode>();
+    auto &queue = queued.addInput<QueuePad>("input", 16);
+    auto &ringed = *pipeline->addNode<CountNode>();
+    auto &ring = ringed.addInput<RingQueuePad>("input", 16);
+    EXPECT_TRUE(pipeline->start());
+
+    EXPECT_FALSE(simple.pushPacket(stalePacket(), 100));
+    EXPECT_EQ(simple.expiredPackets(), 1u);
+    auto fresh = std::make_shared<IPacket>();
+    fresh->setDeadline(std::chrono::milliseconds(500));
+    EXPECT_TRUE(simple.pushPacket(fresh, 10000));
+    EXPECT_EQ(direct.processed.load(), 1u);
+    EXPECT_LE(direct.lastTimeout.load(), 500u);
+
+    // A batch with a stale packet fails like the stale packet alone, and
+    // the fresh packets around it are still queued
+    for (IPad* pad: std::initializer_list<IPad*>{&queue, &ring})
+    {
+        std::vector<std::shared_ptr<IPacket>> batch{std::make_shared<IPacket>(), stalePacket(), std::make_shared<IPacket>()};
+        EXPECT_FALSE(pad->pushBatch(batch, 100));
+        EXPECT_EQ(batch[1], nullptr);
+        EXPECT_EQ(pad->expiredPackets(), 1u);
+    }
+    EXPECT_TRUE(waitFor([&]() { return queued.processed.load() == 2 && ringed.processed.load() == 2; }));
+}
+
+TEST_F(PadTest, PriorityQueuePadSchedulesLanes)
+{
+    class IdPacket : public IPacket {
+    public:
+        explicit IdPacket(int id) : id(id) {}
+        int id;
+    };
+
+    class OrderNode : public INode {
+    public:
+        std::mutex mutex;
+        std::vector<int> order;
+        std::atomic<bool> gate{false};
+        std::atomic<bool> holding{false};
+
+        size_t count()
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            return order.size();
+        }
+
+    protected:
+        bool processPacket(std::shared_ptr<IPacket> packet, IPad& inputPad, uint32_t timeoutMs) noexcept override
+        {
+            holding.store(true);
+            while (!gate.load())
+            {
+                std::this_thread::yield();
+            }
+            std::lock_guard<std::mutex> lock(mutex);
+            order.push_back(static_cast<IdPacket&>(*packet).id);
+            return true;
+        }
+    };
+
+    auto &strict = *pipeline->addNode<OrderNode>();
+    auto &strictInput = strict.addInput<PriorityQueuePad>("input", 2, 16);
+    auto &weighted = *pipeline->addNode<OrderNode>();
+    auto &weightedInput = weighted.addInput<PriorityQueuePad>("input",
+        std::vector<PriorityLane>{{16, 1}, {16, 3}}, LaneScheduling::WEIGHTED);
+
+    // Urgent packets (ids 100 and above) take the high lane
+    auto classifier = [](const IPacket& packet) -> uint8_t { return static_cast<const IdPacket&>(packet).id >= 100; };
+    strictInput.setClassifier(classifier);
+    weightedInput.setClassifier(classifier);
+
+    EXPECT_TRUE(pipeline->start());
+    EXPECT_EQ(strictInput.laneCount(), 2u);
+    EXPECT_EQ(strictInput.queueCapacity(), 32u);
+
+    // Hold a first packet, then queue bulk packets (ids 1..) and urgent ones (ids 100..)
+    auto fill = [&](OrderNode& node, PriorityQueuePad& input) {
+        EXPECT_TRUE(input.pushPacket(std::make_shared<IdPacket>(0), 100));
+        EXPECT_TRUE(waitFor([&]() { return node.holding.load(); }));
+        for (int i = 1; i <= 8; i++)
+        {
+            EXPECT_TRUE(input.pushPacket(std::make_shared<IdPacket>(i), 100));
+            EXPECT_TRUE(input.pushPacket(std::make_shared<IdPacket>(100 + i), 100));
+        }
+        EXPECT_EQ(input.laneDepth(0), 8u);
+        EXPECT_EQ(input.laneDepth(1), 8u);
+        node.gate.store(true);
+        EXPECT_TRUE(waitFor([&]() { return node.count() == 17; }));
+    };
+    fill(strict, strictInput);
+    fill(weighted, weightedInput);
+
+    // The lane can also be chosen when pushing
+    EXPECT_TRUE(weightedInput.pushPacket(std::make_shared<IdPacket>(200), 100, 7));
+    EXPECT_TRUE(waitFor([&]() { return weighted.count() == 18; }));
+    pipeline->stop();
+
+    std::vector<int> strictOrder{0, 101, 102, 103, 104, 105, 106, 107, 108, 1, 2, 3, 4, 5, 6, 7, 8};
+    EXPECT_EQ(strict.order, strictOrder);
+    std::vector<int> weightedOrder{0, 101, 102, 103, 1, 104, 105, 106, 2, 107, 108, 3, 4, 5, 6, 7, 8, 200};
+    EXPECT_EQ(weighted.order, weightedOrder);
+}
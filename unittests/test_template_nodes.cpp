@@ -2,11 +2,13 @@
 #include "pipeline/pipeline.h"
 #include <memory>
 #include <iostream>
+#include <atomic>
+#include <thread>
 
 using namespace lexus2k::pipeline;
 
 // Define custom packet types for testing
-class PacketA : public IPacket {
+class PacketA : public Packet<PacketA> {
 public:
     PacketA() : data(0) {}
     PacketA(size_t value) : data(value) {}
@@ -148,7 +150,7 @@ TEST_F(TemplateNodeTest, SharedMemoryNodeTest) {
 
     uint32_t consumedSum = 0;
     auto &consumer = *pipeline->addNode([&consumedSum](std::shared_ptr<IPacket> packet, IPad& pad) -> bool {
-        auto packetA = std::dynamic_pointer_cast<PacketA>(packet);
+        auto packetA = packet_cast<PacketA>(packet);
         if (!packetA) {
             std::cerr << "Invalid packet type" << std::endl;
             return false;
@@ -213,3 +215,216 @@ TEST_F(TemplateNodeTest, SharedMemoryPerformanceTest) {
               << calculatedPeformance << " packets/s" << std::endl;
     EXPECT_GE(calculatedPeformance, 200000);
 }
+
+TEST_F(TemplateNodeTest, PacketMovesThroughChain) {
+    std::atomic<long> useCount{0};
+    auto& source = *pipeline->addNode([](std::shared_ptr<IPacket> packet, IPad& pad) -> bool {
+        return pad.node()["output"].pushPacket(std::move(packet), 0);
+    });
+    source.addInput("input");
+    source.addOutput("output");
+
+    auto& relay = *pipeline->addNode([](std::shared_ptr<IPacket> packet, IPad& pad) -> bool {
+        return pad.node()["output"].pushPacket(std::move(packet), 0);
+    });
+    relay.addInput<QueuePad>("input");
+    relay.addOutput("output");
+
+    class SinkNode : public Node<PacketA> {
+    public:
+        explicit SinkNode(std::atomic<long>& useCount) : m_useCount(useCount) {}
+    protected:
+        bool processPacket(std::shared_ptr<PacketA> packet, IPad& inputPad, uint32_t timeoutMs) noexcept override {
+            m_useCount = packet.use_count();
+            return true;
+        }
+    private:
+        std::atomic<long>& m_useCount;
+    };
+    auto& sink = *pipeline->addNode<SinkNode>(useCount);
+    sink.addInput("input");
+
+    source["output"].then(relay["input"])["output"].then(sink["input"]);
+    EXPECT_TRUE(pipeline->start());
+
+    // The only reference travels along the chain, nobody keeps a copy
+    EXPECT_TRUE(source["input"].pushPacket(std::make_shared<PacketA>(1), 0));
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(2);
+    while (useCount == 0 && std::chrono::steady_clock::now() < deadline) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    EXPECT_EQ(useCount.load(), 1);
+}
+
+class PacketC : public Packet<PacketC> {
+public:
+};
+
+class FusionNode : public NodeN<PacketA, PacketB, PacketC> {
+protected:
+    bool processPacket(std::shared_ptr<PacketA> packet, IPad& inputPad, uint32_t timeoutMs) noexcept override {
+        processedA++;
+        return true;
+    }
+
+    bool processPacket(std::shared_ptr<PacketB> packet, IPad& inputPad, uint32_t timeoutMs) noexcept override {
+        processedB++;
+        return true;
+    }
+
+    bool processPacket(std::shared_ptr<PacketC> packet, IPad& inputPad, uint32_t timeoutMs) noexcept override {
+        processedC++;
+        return true;
+    }
+
+public:
+    int processedA = 0;
+    int processedB = 0;
+    int processedC = 0;
+};
+
+TEST_F(TemplateNodeTest, VariadicNodeTest) {
+    auto& node = *pipeline->addNode<FusionNode>();
+    node.addInput("inputA");
+    node.addInput("inputB");
+    node.addInput("inputC");
+
+    EXPECT_TRUE(pipeline->start());
+
+    EXPECT_TRUE(node["inputA"].pushPacket(std::make_shared<PacketA>(), 0));
+    EXPECT_TRUE(node["inputB"].pushPacket(std::make_shared<PacketB>(), 0));
+    EXPECT_TRUE(node["inputC"].pushPacket(std::make_shared<PacketC>(), 0));
+    EXPECT_TRUE(node["inputC"].pushPacket(std::make_shared<PacketC>(), 0));
+
+    // Packets of the wrong type for a pad are rejected
+    EXPECT_FALSE(node["inputA"].pushPacket(std::make_shared<PacketC>(), 0));
+    EXPECT_FALSE(node["inputC"].pushPacket(std::make_shared<PacketB>(), 0));
+
+    EXPECT_EQ(node.processedA, 1);
+    EXPECT_EQ(node.processedB, 1);
+    EXPECT_EQ(node.processedC, 2);
+}
+
+TEST_F(TemplateNodeTest, TypedPadsTest) {
+    auto& producer = *pipeline->addNode([](std::shared_ptr<IPacket> packet, IPad& pad) -> bool {
+        auto& output = static_cast<OutputPad<PacketA>&>(pad.node()["output"]);
+        return output.pushPacket(std::make_shared<PacketA>(42), 0);
+    });
+    producer.addInput("input");
+    auto& output = producer.addOutput<OutputPad<PacketA>>("output");
+
+    auto& consumer = *pipeline->addNode<TestNode>();
+    auto& input = consumer.addInput<InputPad<PacketA>>("input");
+
+    // Does not compile: PacketB packets are not accepted by an InputPad<PacketA>
+    // pipeline->connect(producer.addOutput<OutputPad<PacketB>>("other"), input);
+    pipeline->connect(output, input);
+    EXPECT_EQ(input.packetKey(), packetTypeKey<PacketA>());
+
+    EXPECT_TRUE(pipeline->start());
+    EXPECT_TRUE(producer["input"].pushPacket(std::make_shared<IPacket>(), 0));
+    EXPECT_TRUE(consumer.processed);
+
+    // Untyped pushes are checked when they enter the typed pad
+    consumer.processed = false;
+    EXPECT_FALSE(input.pushPacket(std::make_shared<PacketB>(), 0));
+    EXPECT_FALSE(consumer.processed);
+    EXPECT_TRUE(input.pushPacket(std::make_shared<PacketA>(), 0));
+    EXPECT_TRUE(consumer.processed);
+}
+
+TEST_F(TemplateNodeTest, TypedPadsCheckBatches) {
+    class CountNode : public Node<PacketA> {
+    public:
+        std::atomic<size_t> processed{0};
+        std::atomic<size_t> mismatched{0};
+
+    protected:
+        bool processPacket(std::shared_ptr<PacketA> packet, IPad& inputPad, uint32_t timeoutMs) noexcept override {
+            if (!isPacketOf<PacketA>(*packet)) {
+                mismatched++;
+            }
+            processed++;
+            return true;
+        }
+    };
+
+    auto& consumer = *pipeline->addNode<CountNode>();
+    auto& input = consumer.addInput<InputPad<PacketA, QueuePad>>("input", 16);
+    EXPECT_TRUE(pipeline->start());
+
+    // A mixed batch: the PacketA packets are queued in order, the others are left
+    std::vector<std::shared_ptr<IPacket>> batch{std::make_shared<PacketA>(1), std::make_shared<PacketB>(),
+        std::make_shared<PacketA>(2), std::make_shared<PacketC>()};
+    EXPECT_FALSE(input.pushBatch(batch, 100));
+    EXPECT_TRUE(batch[0] == nullptr && batch[1] == nullptr);
+    EXPECT_TRUE(batch[2] != nullptr && batch[3] != nullptr);
+
+    for (int i = 0; i < 2000 && consumer.processed.load() < 2; i++) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    pipeline->stop();
+    EXPECT_EQ(consumer.processed.load(), 2u);
+    EXPECT_EQ(consumer.mismatched.load(), 0u);
+}
+
+struct DoubleStage {
+    std::shared_ptr<PacketA> operator()(std::shared_ptr<PacketA> packet) const {
+        return std::make_shared<PacketA>(packet->getData() * 2);
+    }
+};
+
+TEST_F(TemplateNodeTest, ChainTest) {
+    size_t sum = 0;
+    auto dropSmall = [](std::shared_ptr<PacketA> packet) {
+        return packet->getData() < 4 ? nullptr : packet;
+    };
+    auto accumulate = [&sum](std::shared_ptr<PacketA> packet) {
+        sum += packet->getData();
+    };
+
+    using Fused = Chain<DoubleStage, decltype(dropSmall), DoubleStage>;
+    auto& fused = *pipeline->addNode<Fused>(DoubleStage(), dropSmall, DoubleStage());
+    auto& sink = *pipeline->addNode<Chain<decltype(accumulate)>>(accumulate);
+
+    static_assert(std::is_same_v<Fused::Output, PacketA>);
+    static_assert(std::is_void_v<Chain<decltype(accumulate)>::Output>);
+    EXPECT_EQ(sink.padId("output"), PadId());
+
+    pipeline->connect(fused["output"], sink["input"]);
+    EXPECT_TRUE(pipeline->start());
+
+    for (size_t value = 1; value <= 3; value++) {
+        EXPECT_TRUE(fused["input"].pushPacket(std::make_shared<PacketA>(value), 0));
+    }
+    // 1 is dropped after the first stage, 2 and 3 are doubled twice
+    EXPECT_EQ(sum, 8u + 12u);
+
+    // Packets of the wrong type are rejected at the typed input pad
+    EXPECT_FALSE(fused["input"].pushPacket(std::make_shared<PacketB>(), 0));
+}
+
+TEST_F(TemplateNodeTest, TypedLambdaNodeTest) {
+    size_t received = 0;
+    auto& doubler = *pipeline->addNode([](std::shared_ptr<PacketA> packet, Emit& emit) {
+        return emit(std::make_shared<PacketA>(packet->getData() * 2));
+    });
+    doubler.addInput<InputPad<PacketA>>("input");
+    doubler.addOutput("output");
+
+    auto& sink = *pipeline->addNode([&received](std::shared_ptr<PacketA> packet, Emit& emit) {
+        received = packet->getData();
+        EXPECT_EQ(emit.size(), 0u);
+    });
+    sink.addInput("input");
+
+    pipeline->connect(doubler["output"], sink["input"]);
+    EXPECT_TRUE(pipeline->start());
+
+    EXPECT_TRUE(doubler["input"].pushPacket(std::make_shared<PacketA>(21), 0));
+    EXPECT_EQ(received, 42u);
+
+    // Packets of another type never reach the lambda
+    EXPECT_FALSE(sink["input"].pushPacket(std::make_shared<PacketB>(), 0));
+    EXPECT_EQ(received, 42u);
+}